@@ -1,3 +1,4 @@
 C:/VulkanSDK/1.2.189.2/Bin/glslc.exe shader.vert -o vert.spv
 C:/VulkanSDK/1.2.189.2/Bin/glslc.exe shader.frag -o frag.spv
+C:/VulkanSDK/1.2.189.2/Bin/glslc.exe flowfield.comp -o comp.spv
 pause
\ No newline at end of file
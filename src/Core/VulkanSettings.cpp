@@ -3,6 +3,7 @@
 namespace VulkanProject
 {
 	VulkanSettings* VulkanSettings::vkSettings = nullptr;
+	bool VulkanSettings::headless = false;
 
 	VulkanSettings::VulkanSettings()
 	{
@@ -23,6 +24,15 @@ namespace VulkanProject
 		return vkSettings;
 	}
 
+	void VulkanSettings::setHeadless()
+	{
+		if (vkSettings != nullptr)
+		{
+			throw std::runtime_error("Vulkan is already initialised!");
+		}
+		headless = true;
+	}
+
 	VkDevice VulkanSettings::getLogicalDevice() const
 	{
 		return logicalDevice;
@@ -33,11 +43,19 @@ namespace VulkanProject
 		return physicalDevice;
 	}
 
+	uint32_t VulkanSettings::getComputeQueueFamily() const
+	{
+		return headless ? queueIndices.computeFamily.value() : queueIndices.graphicsFamily.value();
+	}
+
 	void VulkanSettings::init()
 	{
 		createInstance();
 		setupDebugMessenger();
-		createSurface();
+		if (!headless)
+		{
+			createSurface();
+		}
 		pickPhysicalDevice();
 		createLogicalDevice();
 	}
@@ -163,11 +181,15 @@ namespace VulkanProject
 	 */
 	std::vector<const char*> VulkanSettings::getRequiredExtensions()
 	{
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		// Headless runs never initialise glfw and need no surface extensions
+		std::vector<const char*> extensions = std::vector<const char*>();
+		if (!headless)
+		{
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
 
 		if (ENABLE_VALIDATION_LAYERS)
 		{
@@ -224,8 +246,11 @@ namespace VulkanProject
 			LOG("DebugMessenger destroyed.");
 		}
 
-		vkDestroySurfaceKHR(instance, surface, nullptr);
-		LOG("Surface destroyed.");
+		if (!headless)
+		{
+			vkDestroySurfaceKHR(instance, surface, nullptr);
+			LOG("Surface destroyed.");
+		}
 
 		vkDestroyInstance(instance, nullptr);
 		LOG("Vulkan instance destroyed.");
@@ -293,6 +318,12 @@ namespace VulkanProject
 				idx++;
 			}
 
+			// Nobody is there to answer the prompt below in a headless run, so take the first suitable device
+			if (physicalDevice == VK_NULL_HANDLE && headless)
+			{
+				physicalDevice = gpuSelections.front();
+			}
+
 			if (physicalDevice == VK_NULL_HANDLE)
 			{
 				idx = 1;
@@ -332,6 +363,10 @@ namespace VulkanProject
 	bool VulkanSettings::isPhysicalDeviceSuitable(VkPhysicalDevice device)
 	{
 		QueueFamilyIndices indices = findQueueFamilies(device);
+		if (headless)
+		{
+			return indices.computeFamily.has_value();
+		}
 
 		bool extensionsSupported = checkDeviceExtensionSupport(device);
 
@@ -385,7 +420,7 @@ namespace VulkanProject
 		queueIndices = findQueueFamilies(physicalDevice);
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-		std::set<uint32_t> uniqueQueueFamilies = {
+		std::set<uint32_t> uniqueQueueFamilies = headless ? std::set<uint32_t>{ queueIndices.computeFamily.value() } : std::set<uint32_t>{
 			queueIndices.graphicsFamily.value(),
 			queueIndices.presentFamily.value()
 		};
@@ -416,8 +451,9 @@ namespace VulkanProject
 		/* Define logical device validation layers
 		 * This is for legacy Vulkan support as current versions use the same attributes as the Vulkan instance
 		 */
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+		// Without a surface there is nothing to present to, so the swapchain extension is not requested
+		createInfo.enabledExtensionCount = headless ? 0 : static_cast<uint32_t>(deviceExtensions.size());
+		createInfo.ppEnabledExtensionNames = headless ? nullptr : deviceExtensions.data();
 		if (ENABLE_VALIDATION_LAYERS)
 		{
 			createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -473,6 +509,18 @@ namespace VulkanProject
 		int i = 0;
 		for (const auto& queueFamily : queueFamilies)
 		{
+			// Headless runs only compute and there is no surface to ask about presenting
+			if (headless)
+			{
+				if (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)
+				{
+					indices.computeFamily = i;
+					break;
+				}
+				i++;
+				continue;
+			}
+
 			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 			{
 				indices.graphicsFamily = i;
@@ -21,8 +21,13 @@ namespace VulkanProject
 	{
 	public:
 		static VulkanSettings* getInstance();
+		// Call before the first getInstance() to run without a window: no surface, no swapchain extension and a
+		// device with just a compute queue, which is enough for ComputeFlowField but not for the Renderer
+		static void setHeadless();
 		VkDevice getLogicalDevice() const;
 		VkPhysicalDevice getPhysicalDevice() const;
+		// Family compute work is submitted to: the graphics family with a window, a compute family without
+		uint32_t getComputeQueueFamily() const;
 
 	private:
 		VulkanSettings();
@@ -32,6 +37,8 @@ namespace VulkanProject
 		{
 			std::optional<uint32_t> graphicsFamily;
 			std::optional<uint32_t> presentFamily;
+			// Only looked for in headless mode
+			std::optional<uint32_t> computeFamily;
 
 			bool isComplete()
 			{
@@ -86,6 +93,7 @@ namespace VulkanProject
 
 	private:
 		static VulkanSettings* vkSettings;
+		static bool headless;
 
 		VkInstance instance;
 		VkDebugUtilsMessengerEXT debugMessenger;
@@ -1,10 +1,96 @@
 #define STB_IMAGE_IMPLEMENTATION
+#include "../Renderer/ComputeFlowField.h"
 #include "../Renderer/Renderer.h"
+#include "../Utilities/Benchmark.h"
+#include "../Utilities/GridFile.h"
+#include "../Utilities/PathScheduler.h"
 
 using namespace VulkanProject;
 
-int main()
+int main(int argc, char* argv[])
 {
+	// "--convert-grid Barriers.txt Barriers.grid [chunkSize]" writes the binary grid format and exits without opening a window.
+	// With a chunk size (256 is a good start) the file is tiled and gets paged in on demand when loaded.
+	if ((argc == 4 || argc == 5) && std::string(argv[1]) == "--convert-grid")
+	{
+		int chunkSize = argc == 5 ? atoi(argv[4]) : 0;
+		return GridFile::convert(argv[2], argv[3], chunkSize) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// "--benchmark <map> [<scen>] [--mode <name>] [--threads <n>] [--out <report.json>]" runs the scenarios headless and writes
+	// a JSON report
+	if (argc >= 3 && std::string(argv[1]) == "--benchmark")
+	{
+		std::string scenarioPath = "";
+		std::string reportPath = "";
+		SearchContext::SEARCH_MODE mode = SearchContext::SEARCH_MODE::A_STAR;
+		unsigned int threadCount = 0;
+		for (int i = 3; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			if (argument == "--mode" && i + 1 < argc)
+			{
+				if (!Benchmark::parseMode(argv[++i], mode))
+				{
+					std::cerr << "ERROR::Unknown search mode!" << std::endl;
+					return EXIT_FAILURE;
+				}
+			}
+			else if (argument == "--threads" && i + 1 < argc)
+			{
+				threadCount = (unsigned int)atoi(argv[++i]);
+			}
+			else if (argument == "--out" && i + 1 < argc)
+			{
+				reportPath = argv[++i];
+			}
+			else
+			{
+				scenarioPath = argument;
+			}
+		}
+
+		if (reportPath.empty())
+		{
+			return Benchmark::run(argv[2], scenarioPath, mode, std::cout, threadCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		std::ofstream report(reportPath);
+		return report.is_open() && Benchmark::run(argv[2], scenarioPath, mode, report, threadCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// "--validate-flow-field <map> <goalX> <goalY>" builds the flow field with the compute shader and compares it with the
+	// CPU one. It opens no window and needs only a compute queue, so CI can run it on a software driver like lavapipe.
+	if (argc == 5 && std::string(argv[1]) == "--validate-flow-field")
+	{
+		try
+		{
+			VulkanSettings::setHeadless();
+			if (!Benchmark::loadMap(argv[2]))
+			{
+				return EXIT_FAILURE;
+			}
+
+			int goal[2] = { atoi(argv[3]), atoi(argv[4]) };
+			ComputeFlowField computeField;
+			computeField.build(goal);
+			computeField.readBack();
+			FlowField reference;
+			reference.build(goal);
+			size_t mismatches = computeField.countMismatches(reference);
+			std::cout << "Compute flow field: " << computeField.getPassCount() << " passes, "
+				<< mismatches << " mismatched tiles" << std::endl;
+
+			vkDeviceWaitIdle(VulkanSettings::getInstance()->getLogicalDevice());
+			computeField.cleanUp();
+			return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
 	try
 	{
 		GLFWwindow& window = Window::getInstance();
@@ -13,6 +99,8 @@ int main()
 		while (!glfwWindowShouldClose(&window))
 		{
 			glfwPollEvents();
+			// Path queries get a fixed slice of every frame instead of stalling it
+			PathScheduler::getInstance()->update();
 			renderer->drawFrame();
 			renderer->calculateFPS();
 		}
@@ -23,6 +111,9 @@ int main()
 		LOG("=========================");
 		Window::cleanUp();
 		renderer->cleanUp();
+#ifdef SEARCH_STATS
+		SearchCounters::getInstance()->dump(std::cout);
+#endif
 	}
 	catch (const std::exception& e)
 	{
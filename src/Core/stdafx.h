@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 
+// windows.h (pulled in by glfw3native.h) must not turn std::min/std::max into macros
+#define NOMINMAX
 #define VK_USE_PLATFORM_WIN32_KHR
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
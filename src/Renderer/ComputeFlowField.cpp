@@ -0,0 +1,462 @@
+#include "ComputeFlowField.h"
+
+namespace VulkanProject
+{
+	ComputeFlowField::ComputeFlowField()
+	{
+		VulkanSettings* vkSettings = VulkanSettings::getInstance();
+		logicalDevice = vkSettings->getLogicalDevice();
+		uint32_t queueFamily = vkSettings->getComputeQueueFamily();
+
+		// With a window this is the graphics family, and Vulkan only promises compute on some graphics-capable
+		// family, not on every one
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(vkSettings->getPhysicalDevice(), &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(vkSettings->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+		if (!(queueFamilies[queueFamily].queueFlags & VK_QUEUE_COMPUTE_BIT))
+		{
+			throw std::runtime_error("The queue family does not support compute!");
+		}
+		vkGetDeviceQueue(logicalDevice, queueFamily, 0, &queue);
+
+		VkCommandPoolCreateInfo commandPoolInfo{};
+		commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolInfo.queueFamilyIndex = queueFamily;
+		commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		if (vkCreateCommandPool(logicalDevice, &commandPoolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create the compute command pool!");
+		}
+
+		createDescriptorSetLayout();
+		createPipeline();
+		createDescriptorPool();
+		LOG("Compute flow field created.");
+	}
+
+	ComputeFlowField::~ComputeFlowField()
+	{
+	}
+
+	void ComputeFlowField::build(const int goal[2])
+	{
+		Grid::ensureLoaded();
+		goalX = goal[0];
+		goalY = goal[1];
+		gridVersion = Grid::getVersion();
+
+		if (Grid::getWidth() != bufferWidth || Grid::getHeight() != bufferHeight)
+		{
+			destroyBuffers();
+			createBuffers();
+			updateDescriptorSet();
+			barriersUploaded = false;
+		}
+		if (!barriersUploaded || barrierVersion != gridVersion)
+		{
+			uploadBarriers();
+		}
+
+		// Nothing can move into a barrier, so a goal on one is unreachable from everywhere
+		parameters.width = bufferWidth;
+		parameters.height = bufferHeight;
+		parameters.rowUints = Grid::getRowWords() * 2;
+		parameters.goalIndex = Grid::inBounds(goalX, goalY) && !Grid::isBarrier(goalX, goalY) ? Grid::indexOf(goalX, goalY) : -1;
+		passCount = 0;
+
+		// Relax in batches until the last pass of a batch lowers no distance; 'changed' is cleared just before that
+		// pass, so a set flag means at least one more pass is needed
+		VkCommandBuffer commandBuffer = beginCommands();
+		recordPass(commandBuffer, PASS::INITIALISE);
+		bool converged = parameters.goalIndex < 0;
+		while (!converged)
+		{
+			for (int pass = 0; pass < PASSES_PER_SUBMIT; pass++)
+			{
+				if (pass == PASSES_PER_SUBMIT - 1)
+				{
+					vkCmdFillBuffer(commandBuffer, changedBuffer, 0, sizeof(uint32_t), 0);
+					recordBarrier(commandBuffer);
+				}
+				recordPass(commandBuffer, PASS::RELAX);
+			}
+			passCount += PASSES_PER_SUBMIT;
+
+			Buffer::endCommandBuffer(commandBuffer, queue, commandPool);
+			converged = *changed == 0;
+			commandBuffer = beginCommands();
+		}
+		recordPass(commandBuffer, PASS::DIRECTIONS);
+		Buffer::endCommandBuffer(commandBuffer, queue, commandPool);
+	}
+
+	void ComputeFlowField::readBack()
+	{
+		VkDeviceSize fieldSize = (VkDeviceSize)bufferWidth * bufferHeight * sizeof(float);
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		Buffer::createBuffer(fieldSize * 2, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+		// Distances first, directions after them
+		VkCommandBuffer commandBuffer = beginCommands();
+		VkBufferCopy copyRegion{};
+		copyRegion.size = fieldSize;
+		vkCmdCopyBuffer(commandBuffer, distanceBuffer, stagingBuffer, 1, &copyRegion);
+		copyRegion.dstOffset = fieldSize;
+		vkCmdCopyBuffer(commandBuffer, directionBuffer, stagingBuffer, 1, &copyRegion);
+		recordBarrier(commandBuffer);
+		Buffer::endCommandBuffer(commandBuffer, queue, commandPool);
+
+		size_t tileCount = (size_t)bufferWidth * bufferHeight;
+		void* data;
+		vkMapMemory(logicalDevice, stagingBufferMemory, 0, fieldSize * 2, 0, &data);
+		const float* fieldDistances = static_cast<const float*>(data);
+		const int32_t* fieldDirections = reinterpret_cast<const int32_t*>(fieldDistances + tileCount);
+		distances.assign(fieldDistances, fieldDistances + tileCount);
+		directions.resize(tileCount);
+		for (size_t i = 0; i < tileCount; i++)
+		{
+			directions[i] = (int8_t)fieldDirections[i];
+		}
+		vkUnmapMemory(logicalDevice, stagingBufferMemory);
+
+		vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
+		vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
+	}
+
+	int ComputeFlowField::getGoalX() const
+	{
+		return goalX;
+	}
+
+	int ComputeFlowField::getGoalY() const
+	{
+		return goalY;
+	}
+
+	uint64_t ComputeFlowField::getGridVersion() const
+	{
+		return gridVersion;
+	}
+
+	double ComputeFlowField::getDistance(int x, int y) const
+	{
+		// The shader's infinity converts to NodeTable::UNREACHED
+		return distances[(size_t)y * bufferWidth + x];
+	}
+
+	int ComputeFlowField::getDirection(int x, int y) const
+	{
+		return directions[(size_t)y * bufferWidth + x];
+	}
+
+	VkBuffer ComputeFlowField::getDistanceBuffer() const
+	{
+		return distanceBuffer;
+	}
+
+	VkBuffer ComputeFlowField::getDirectionBuffer() const
+	{
+		return directionBuffer;
+	}
+
+	int ComputeFlowField::getPassCount() const
+	{
+		return passCount;
+	}
+
+	size_t ComputeFlowField::countMismatches(const FlowField& reference) const
+	{
+		if (distances.size() != (size_t)Grid::getWidth() * Grid::getHeight())
+		{
+			throw std::runtime_error("The compute flow field has not been read back!");
+		}
+
+		size_t mismatches = 0;
+		for (int y = 0; y < bufferHeight; y++)
+		{
+			for (int x = 0; x < bufferWidth; x++)
+			{
+				double expected = reference.getDistance(x, y);
+				double actual = getDistance(x, y);
+				int direction = getDirection(x, y);
+				if (std::isinf(expected) || std::isinf(actual))
+				{
+					mismatches += std::isinf(expected) != std::isinf(actual) || direction != FlowField::NO_DIRECTION;
+					continue;
+				}
+				if (std::abs(actual - expected) > TOLERANCE * std::max(1.0, expected))
+				{
+					mismatches++;
+					continue;
+				}
+				if (x == goalX && y == goalY)
+				{
+					mismatches += direction != FlowField::NO_DIRECTION;
+					continue;
+				}
+
+				// Ties may pick another move than the CPU field did, so only check that the move is a shortest one
+				if (direction == FlowField::NO_DIRECTION)
+				{
+					mismatches++;
+					continue;
+				}
+				int nextX = x + Grid::DIRECTION_X[direction];
+				int nextY = y + Grid::DIRECTION_Y[direction];
+				double stepCost = direction < 4 ? 1.0 : sqrt(2.0);
+				mismatches += !Grid::inBounds(nextX, nextY) || Grid::isBarrier(nextX, nextY)
+					|| std::abs(reference.getDistance(nextX, nextY) + stepCost - expected) > TOLERANCE * std::max(1.0, expected);
+			}
+		}
+		return mismatches;
+	}
+
+	void ComputeFlowField::cleanUp()
+	{
+		destroyBuffers();
+		vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
+		vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+		vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+		vkDestroyDescriptorSetLayout(logicalDevice, descriptorSetLayout, nullptr);
+		vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+		LOG("Compute flow field resources cleaned up.");
+	}
+
+	void ComputeFlowField::createDescriptorSetLayout()
+	{
+		// Barriers, distances, directions and the changed flag, in the order of the shader's bindings
+		VkDescriptorSetLayoutBinding bindings[4]{};
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			bindings[i].binding = i;
+			bindings[i].descriptorCount = 1;
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 4;
+		layoutInfo.pBindings = bindings;
+
+		if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create compute descriptor set layout!");
+		}
+	}
+
+	void ComputeFlowField::createPipeline()
+	{
+		Shader computeShader = Shader(Shader::SHADER_TYPE::COMPUTE, logicalDevice);
+
+		VkPipelineShaderStageCreateInfo shaderStageInfo{};
+		shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		shaderStageInfo.module = computeShader.getShaderModule();
+		shaderStageInfo.pName = "main";
+
+		// The grid size, goal and pass change between dispatches without touching the descriptor set
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(Parameters);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create compute pipeline layout!");
+		}
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = shaderStageInfo;
+		pipelineInfo.layout = pipelineLayout;
+
+		if (vkCreateComputePipelines(logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create compute pipeline!");
+		}
+
+		vkDestroyShaderModule(logicalDevice, computeShader.getShaderModule(), nullptr);
+	}
+
+	void ComputeFlowField::createDescriptorPool()
+	{
+		VkDescriptorPoolSize poolSize{};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = 4;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		poolInfo.maxSets = 1;
+
+		if (vkCreateDescriptorPool(logicalDevice, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create compute descriptor pool!");
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, &descriptorSet) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate compute descriptor set!");
+		}
+	}
+
+	void ComputeFlowField::createBuffers()
+	{
+		bufferWidth = Grid::getWidth();
+		bufferHeight = Grid::getHeight();
+		VkDeviceSize barrierSize = (VkDeviceSize)Grid::getRowWords() * bufferHeight * sizeof(uint64_t);
+		VkDeviceSize fieldSize = (VkDeviceSize)bufferWidth * bufferHeight * sizeof(float);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(VulkanSettings::getInstance()->getPhysicalDevice(), &properties);
+		if (std::max(barrierSize, fieldSize) > properties.limits.maxStorageBufferRange)
+		{
+			throw std::runtime_error("Grid is too large for a storage buffer!");
+		}
+
+		Buffer::createBuffer(barrierSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, barrierBuffer, barrierBufferMemory);
+		Buffer::createBuffer(fieldSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, distanceBuffer, distanceBufferMemory);
+		Buffer::createBuffer(fieldSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, directionBuffer, directionBufferMemory);
+
+		// Read after every batch of passes, so it stays mapped
+		Buffer::createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, changedBuffer, changedBufferMemory);
+		void* data;
+		vkMapMemory(logicalDevice, changedBufferMemory, 0, sizeof(uint32_t), 0, &data);
+		changed = static_cast<uint32_t*>(data);
+	}
+
+	void ComputeFlowField::destroyBuffers()
+	{
+		if (changed != nullptr)
+		{
+			vkUnmapMemory(logicalDevice, changedBufferMemory);
+			changed = nullptr;
+		}
+
+		VkBuffer* buffers[] = { &barrierBuffer, &distanceBuffer, &directionBuffer, &changedBuffer };
+		VkDeviceMemory* memories[] = { &barrierBufferMemory, &distanceBufferMemory, &directionBufferMemory, &changedBufferMemory };
+		for (int i = 0; i < 4; i++)
+		{
+			vkDestroyBuffer(logicalDevice, *buffers[i], nullptr);
+			vkFreeMemory(logicalDevice, *memories[i], nullptr);
+			*buffers[i] = VK_NULL_HANDLE;
+			*memories[i] = VK_NULL_HANDLE;
+		}
+		bufferWidth = 0;
+		bufferHeight = 0;
+	}
+
+	void ComputeFlowField::updateDescriptorSet()
+	{
+		VkBuffer buffers[] = { barrierBuffer, distanceBuffer, directionBuffer, changedBuffer };
+		VkDescriptorBufferInfo bufferInfos[4]{};
+		VkWriteDescriptorSet descriptorWrites[4]{};
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			bufferInfos[i].buffer = buffers[i];
+			bufferInfos[i].offset = 0;
+			bufferInfos[i].range = VK_WHOLE_SIZE;
+
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = descriptorSet;
+			descriptorWrites[i].dstBinding = i;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[i].descriptorCount = 1;
+			descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+
+		vkUpdateDescriptorSets(logicalDevice, 4, descriptorWrites, 0, nullptr);
+	}
+
+	void ComputeFlowField::uploadBarriers()
+	{
+		int rowWords = Grid::getRowWords();
+		VkDeviceSize barrierSize = (VkDeviceSize)rowWords * bufferHeight * sizeof(uint64_t);
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		Buffer::createBuffer(barrierSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+		// Word by word rather than row by row, so paged grids upload the same way; on little-endian hosts the
+		// shader reads each 64-bit word as two 32-bit ones with the same bit order
+		void* data;
+		vkMapMemory(logicalDevice, stagingBufferMemory, 0, barrierSize, 0, &data);
+		uint64_t* words = static_cast<uint64_t*>(data);
+		for (int y = 0; y < bufferHeight; y++)
+		{
+			for (int word = 0; word < rowWords; word++)
+			{
+				words[(size_t)y * rowWords + word] = Grid::getBarrierWord(y, word);
+			}
+		}
+		vkUnmapMemory(logicalDevice, stagingBufferMemory);
+
+		Buffer::copyBuffer(stagingBuffer, barrierBuffer, barrierSize, queue, commandPool);
+		vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
+		vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
+		barrierVersion = gridVersion;
+		barriersUploaded = true;
+	}
+
+	VkCommandBuffer ComputeFlowField::beginCommands()
+	{
+		VkCommandBuffer commandBuffer = Buffer::createCommandBuffer(commandPool);
+		Buffer::beginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+		// Covers writes of earlier submits that end without a barrier, like the copy of the barrier bits
+		recordBarrier(commandBuffer);
+		return commandBuffer;
+	}
+
+	void ComputeFlowField::recordPass(VkCommandBuffer commandBuffer, PASS pass)
+	{
+		parameters.pass = (int32_t)pass;
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Parameters), &parameters);
+		vkCmdDispatch(commandBuffer, (bufferWidth + GROUP_SIZE - 1) / GROUP_SIZE, (bufferHeight + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+		recordBarrier(commandBuffer);
+	}
+
+	/*
+	* Make every earlier shader or transfer write visible to everything after it, including the host once the
+	* submit has finished. The passes are dependent on each other anyway, so a finer barrier would buy nothing.
+	*/
+	void ComputeFlowField::recordBarrier(VkCommandBuffer commandBuffer)
+	{
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT
+			| VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+}
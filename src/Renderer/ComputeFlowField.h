@@ -0,0 +1,106 @@
+#pragma once
+#include "Buffer.h"
+#include "Shader.h"
+#include "../Utilities/FlowField.h"
+
+namespace VulkanProject
+{
+	// FlowField built on the GPU by Shaders/flowfield.comp. The barrier bits are uploaded once per grid version,
+	// then relaxation passes run until a pass changes no distance. The distance and direction buffers stay on
+	// the device for rendering; readBack() copies them to the host. With a window, work is submitted to the
+	// graphics queue, so use it from the render thread only; VulkanSettings::setHeadless() runs it without one.
+	class ComputeFlowField
+	{
+	public:
+		ComputeFlowField();
+		~ComputeFlowField();
+		void build(const int goal[2]);
+		// Copies the fields of the last build to the host for getDistance and getDirection
+		void readBack();
+		int getGoalX() const;
+		int getGoalY() const;
+		uint64_t getGridVersion() const;
+		// Same meaning as in FlowField, read from the last readBack()
+		double getDistance(int x, int y) const;
+		int getDirection(int x, int y) const;
+		// float per tile, infinity where the goal cannot be reached
+		VkBuffer getDistanceBuffer() const;
+		// int per tile, FlowField::NO_DIRECTION or an index into Grid::DIRECTION_X/Y
+		VkBuffer getDirectionBuffer() const;
+		// Relaxation passes dispatched by the last build
+		int getPassCount() const;
+		// Tiles whose distance or direction disagrees with a CPU field built for the same goal
+		size_t countMismatches(const FlowField& reference) const;
+		void cleanUp();
+
+	private:
+		// Must match the push constants of the shader
+		struct Parameters
+		{
+			int32_t width;
+			int32_t height;
+			int32_t rowUints;
+			int32_t goalIndex;
+			int32_t pass;
+		};
+
+		enum class PASS
+		{
+			INITIALISE,
+			RELAX,
+			DIRECTIONS
+		};
+
+		void createDescriptorSetLayout();
+		void createPipeline();
+		void createDescriptorPool();
+		void createBuffers();
+		void destroyBuffers();
+		void updateDescriptorSet();
+		void uploadBarriers();
+		VkCommandBuffer beginCommands();
+		void recordPass(VkCommandBuffer commandBuffer, PASS pass);
+		void recordBarrier(VkCommandBuffer commandBuffer);
+
+		// Workgroup edge, must match local_size in the shader
+		static const int GROUP_SIZE = 16;
+		// Relaxation passes recorded per submit; convergence is only checked between submits
+		static const int PASSES_PER_SUBMIT = 8;
+		// Relative error allowed against the CPU field, whose distances are summed in double
+		static constexpr double TOLERANCE = 1e-4;
+
+		VkDevice logicalDevice;
+		VkQueue queue;
+		VkCommandPool commandPool;
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout pipelineLayout;
+		VkPipeline pipeline;
+		VkDescriptorPool descriptorPool;
+		VkDescriptorSet descriptorSet;
+
+		VkBuffer barrierBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory barrierBufferMemory = VK_NULL_HANDLE;
+		VkBuffer distanceBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory distanceBufferMemory = VK_NULL_HANDLE;
+		VkBuffer directionBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory directionBufferMemory = VK_NULL_HANDLE;
+		// Host-visible flag the shader sets when a pass lowers any distance
+		VkBuffer changedBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory changedBufferMemory = VK_NULL_HANDLE;
+		uint32_t* changed = nullptr;
+
+		Parameters parameters = Parameters();
+		int goalX = 0;
+		int goalY = 0;
+		// Size and version the buffers were created and filled for
+		int bufferWidth = 0;
+		int bufferHeight = 0;
+		uint64_t barrierVersion = 0;
+		bool barriersUploaded = false;
+		uint64_t gridVersion = 0;
+		int passCount = 0;
+
+		std::vector<float> distances;
+		std::vector<int8_t> directions;
+	};
+}
@@ -38,6 +38,10 @@ namespace VulkanProject
 		{
 			return std::string("Shaders/frag.spv");
 		}
+		else if (shaderType == SHADER_TYPE::COMPUTE)
+		{
+			return std::string("Shaders/comp.spv");
+		}
 
 		throw std::runtime_error("No valid shader type found!");
 	}
@@ -13,7 +13,8 @@ namespace VulkanProject
 			VERTEX,
 			TESSELLATION,
 			GEOMETRY,
-			FRAGMENT
+			FRAGMENT,
+			COMPUTE
 		};
 
 		Shader(Shader::SHADER_TYPE shaderType, VkDevice logicalDevice);
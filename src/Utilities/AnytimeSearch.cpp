@@ -0,0 +1,303 @@
+#include "AnytimeSearch.h"
+#include "NodeTable.h"
+#include "SearchPolicies.h"
+
+namespace VulkanProject
+{
+	AnytimeSearch::AnytimeSearch(double initialWeight, double weightStep)
+	{
+		this->initialWeight = std::max(initialWeight, 1.0);
+		this->weightStep = weightStep > 0 ? weightStep : DEFAULT_WEIGHT_STEP;
+	}
+
+	AnytimeSearch::~AnytimeSearch()
+	{
+	}
+
+	Path AnytimeSearch::generatePath(const int start[2], const int goal[2])
+	{
+		return generatePath(start, goal, Limits());
+	}
+
+	Path AnytimeSearch::generatePath(const int start[2], const int goal[2], const Limits& limits)
+	{
+		Path path = Path(start, goal);
+		Grid::ensureLoaded();
+		this->limits = limits;
+		deadline = std::chrono::steady_clock::now() +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(limits.milliseconds));
+		bound = NodeTable::UNREACHED;
+		pathCost = NodeTable::UNREACHED;
+		expansionCount = 0;
+		generatedCount = 0;
+		passCount = 0;
+
+		if (!Grid::inBounds(start[0], start[1]) || !Grid::inBounds(goal[0], goal[1]) ||
+			!Grid::areConnected(start[0], start[1], goal[0], goal[1]))
+		{
+			LOG("No Path Found.");
+			openNodes.clear();
+			return path;
+		}
+
+		width = Grid::getWidth();
+		startIndex = Grid::indexOf(start[0], start[1]);
+		goalIndex = Grid::indexOf(goal[0], goal[1]);
+		beginQuery(width * Grid::getHeight());
+
+		if (startIndex == goalIndex)
+		{
+			LOG("Path Found.");
+			bound = 1;
+			pathCost = 0;
+			path.setSequence(std::vector<Tile>());
+			return path;
+		}
+
+		double weight = initialWeight;
+		records[startIndex] = NodeRecord{ 0, startIndex, generation, 0, 0 };
+		beginPass();
+		openNodes.push(startIndex, weight * estimate(startIndex), estimate(startIndex));
+
+		while (improvePath(weight))
+		{
+			// Only reachable through a barrier start, which areConnected already rules out
+			if (getG(goalIndex) == NodeTable::UNREACHED)
+			{
+				break;
+			}
+
+			passCount++;
+			collectQueued();
+			publish(path, weight);
+			if (bound <= 1 || outOfBudget() || (limits.milliseconds > 0 && std::chrono::steady_clock::now() >= deadline))
+			{
+				break;
+			}
+
+			// Lower the weight and carry every open or inconsistent node over, keyed for the new weight
+			weight = std::max(1.0, weight - weightStep);
+			beginPass();
+			for (int node : queuedNodes)
+			{
+				double remaining = estimate(node);
+				openNodes.push(node, getG(node) + weight * remaining, remaining);
+			}
+		}
+
+		if (bound == NodeTable::UNREACHED)
+		{
+			LOG("No Path Found.");
+		}
+		else
+		{
+			LOG("Path Found.");
+		}
+		return path;
+	}
+
+	double AnytimeSearch::getSuboptimalityBound() const
+	{
+		return bound;
+	}
+
+	double AnytimeSearch::getPathCost() const
+	{
+		return pathCost;
+	}
+
+	size_t AnytimeSearch::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	int AnytimeSearch::getPassCount() const
+	{
+		return passCount;
+	}
+
+	size_t AnytimeSearch::getAllocationCount() const
+	{
+		return allocationCount + openNodes.getAllocationCount();
+	}
+
+	size_t AnytimeSearch::getAllocatedBytes() const
+	{
+		return allocatedBytes + openNodes.getAllocatedBytes();
+	}
+
+	void AnytimeSearch::setCounting(bool counting)
+	{
+		this->counting = counting;
+		openNodes.setCounting(counting);
+	}
+
+	void AnytimeSearch::addStats(SearchStats& stats) const
+	{
+		stats.nodesExpanded += expansionCount;
+		stats.nodesGenerated += generatedCount;
+		openNodes.addStats(stats);
+	}
+
+	void AnytimeSearch::beginQuery(int nodeCount)
+	{
+		if ((int)records.size() != nodeCount)
+		{
+			records.assign(nodeCount, NodeRecord{ NodeTable::UNREACHED, NodeTable::NO_PARENT, 0, 0, 0 });
+			generation = 0;
+			pass = 0;
+			allocationCount++;
+			allocatedBytes += nodeCount * sizeof(NodeRecord);
+		}
+		openNodes.resize(nodeCount);
+		inconsistentNodes.clear();
+		queuedNodes.clear();
+
+		// Passes keep counting across queries, so a stale pass stamp can never match the current one
+		generation++;
+		if (generation == 0 || pass > UINT32_MAX - 1024)
+		{
+			for (NodeRecord& record : records)
+			{
+				record.generation = 0;
+				record.closedPass = 0;
+				record.inconsistentPass = 0;
+			}
+			generation = 1;
+			pass = 0;
+		}
+	}
+
+	void AnytimeSearch::beginPass()
+	{
+		// Starting a pass empties CLOSED and INCONS in O(1)
+		pass++;
+		inconsistentNodes.clear();
+	}
+
+	bool AnytimeSearch::improvePath(double weight)
+	{
+		// Nodes are queued by g + weight * h; the pass ends once none of them can beat the goal's g under that weight
+		while (!openNodes.empty())
+		{
+			int current = openNodes.top();
+			if (getG(goalIndex) <= openNodes.getKey(current))
+			{
+				return true;
+			}
+			// The first pass has no earlier path to fall back on, so it always finishes
+			if (passCount > 0 && outOfBudget())
+			{
+				return false;
+			}
+
+			openNodes.pop();
+			expansionCount++;
+			records[current].closedPass = pass;
+
+			int currentX = current % width;
+			int currentY = current / width;
+			double currentG = records[current].g;
+			for (uint32_t moves = EightConnected::allowedMoves(currentX, currentY); moves != 0; moves &= moves - 1)
+			{
+				int direction = std::countr_zero(moves);
+				int neighbor = current + Grid::DIRECTION_Y[direction] * width + Grid::DIRECTION_X[direction];
+				double neighborG = currentG + (direction < 4 ? CostModel<double>::ORTHOGONAL : CostModel<double>::DIAGONAL);
+				SEARCH_STATS_COUNT(counting, generatedCount);
+				if (neighborG >= getG(neighbor))
+				{
+					continue;
+				}
+
+				NodeRecord& record = records[neighbor];
+				if (record.generation != generation)
+				{
+					record = NodeRecord{ NodeTable::UNREACHED, NodeTable::NO_PARENT, generation, 0, 0 };
+				}
+				record.g = neighborG;
+				record.parent = current;
+
+				// A node already expanded in this pass is not reopened; the next pass picks it up instead
+				if (record.closedPass == pass)
+				{
+					if (record.inconsistentPass != pass)
+					{
+						record.inconsistentPass = pass;
+						inconsistentNodes.push_back(neighbor);
+					}
+					continue;
+				}
+
+				double remaining = estimate(neighbor);
+				if (openNodes.contains(neighbor))
+				{
+					openNodes.decreaseKey(neighbor, neighborG + weight * remaining, remaining);
+				}
+				else
+				{
+					openNodes.push(neighbor, neighborG + weight * remaining, remaining);
+				}
+			}
+		}
+		return true;
+	}
+
+	void AnytimeSearch::collectQueued()
+	{
+		queuedNodes.clear();
+		while (!openNodes.empty())
+		{
+			queuedNodes.push_back(openNodes.pop());
+		}
+		queuedNodes.insert(queuedNodes.end(), inconsistentNodes.begin(), inconsistentNodes.end());
+	}
+
+	void AnytimeSearch::publish(Path& path, double weight)
+	{
+		// The optimal path leaves the settled region through some queued node, so the smallest unweighted
+		// g + h among them bounds the optimum from below
+		double lowerBound = NodeTable::UNREACHED;
+		for (int node : queuedNodes)
+		{
+			lowerBound = std::min(lowerBound, getG(node) + estimate(node));
+		}
+
+		// Nodes improved after they were expanded leave the parent chain cheaper than the goal's g, so cost the chain itself
+		pathCost = 0;
+		size_t length = 0;
+		for (int node = goalIndex; node != startIndex; node = records[node].parent)
+		{
+			int parent = records[node].parent;
+			bool diagonal = node % width != parent % width && node / width != parent / width;
+			pathCost += diagonal ? CostModel<double>::DIAGONAL : CostModel<double>::ORTHOGONAL;
+			length++;
+		}
+		bound = lowerBound == NodeTable::UNREACHED ? 1.0 : std::clamp(pathCost / lowerBound, 1.0, weight);
+
+		std::vector<Tile> sequence = std::vector<Tile>(length);
+		for (int node = goalIndex; node != startIndex; node = records[node].parent)
+		{
+			sequence[--length] = Grid::at(node);
+		}
+		path.setSequence(std::move(sequence));
+	}
+
+	bool AnytimeSearch::outOfBudget() const
+	{
+		if (limits.expansions != 0 && expansionCount >= limits.expansions)
+		{
+			return true;
+		}
+		return limits.milliseconds > 0 && expansionCount % CLOCK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline;
+	}
+
+	double AnytimeSearch::getG(int node) const
+	{
+		return records[node].generation == generation ? records[node].g : NodeTable::UNREACHED;
+	}
+
+	double AnytimeSearch::estimate(int node) const
+	{
+		return OctileHeuristic::estimate<double>(abs(node % width - goalIndex % width), abs(node / width - goalIndex / width));
+	}
+}
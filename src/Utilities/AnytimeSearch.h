@@ -0,0 +1,101 @@
+#pragma once
+#include "IndexedHeap.h"
+#include "Path.h"
+#include <chrono>
+
+namespace VulkanProject
+{
+	// ARA*: a weighted A* pass with an inflated heuristic finds a path quickly, then further passes with smaller
+	// weights improve it, reusing the earlier passes' work, until the path is optimal or the budget is spent.
+	// Every completed pass publishes its path together with a proven bound on how far it is from optimal.
+	// Holds scratch state for one query at a time; not safe to share between threads.
+	class AnytimeSearch
+	{
+	public:
+		// Like ARA*, the limits only cut the improving passes short: the first weighted pass always runs to the
+		// goal, so a connected query always gets a path, however long that pass takes past the deadline
+		static constexpr double DEFAULT_MILLISECONDS = 2.0;
+		static constexpr double DEFAULT_INITIAL_WEIGHT = 3.0;
+		static constexpr double DEFAULT_WEIGHT_STEP = 0.5;
+
+		// A zero limit is no limit; neither applies until the first pass has published a path
+		struct Limits
+		{
+			double milliseconds = DEFAULT_MILLISECONDS;
+			size_t expansions = 0;
+		};
+
+		AnytimeSearch(double initialWeight = DEFAULT_INITIAL_WEIGHT, double weightStep = DEFAULT_WEIGHT_STEP);
+		~AnytimeSearch();
+		// Returns the best path published before the limits ran out, which is at least the first pass's path
+		// whenever the tiles are connected
+		Path generatePath(const int start[2], const int goal[2], const Limits& limits);
+		// Searches under the default limits
+		Path generatePath(const int start[2], const int goal[2]);
+		// The returned path costs at most this many times the optimum: 1 when it is optimal,
+		// NodeTable::UNREACHED when no path was returned
+		double getSuboptimalityBound() const;
+		// Cost of the returned path in tiles
+		double getPathCost() const;
+		// Nodes taken off the open list by the most recent query, over all its passes
+		size_t getExpansionCount() const;
+		// Passes completed by the most recent query
+		int getPassCount() const;
+		// Number of times the scratch tables had to grow, and the bytes they grew by
+		size_t getAllocationCount() const;
+		size_t getAllocatedBytes() const;
+		// Generated nodes and heap operations are only counted while counting is on (see SEARCH_STATS_COUNT)
+		void setCounting(bool counting);
+		// Adds the most recent query's counts
+		void addStats(SearchStats& stats) const;
+
+	private:
+		struct NodeRecord
+		{
+			double g;
+			int parent;
+			uint32_t generation;
+			// Pass in which the node was last expanded, or queued as inconsistent
+			uint32_t closedPass;
+			uint32_t inconsistentPass;
+		};
+
+		// Reading the clock costs more than an expansion, so the deadline is only checked this often
+		static const size_t CLOCK_INTERVAL = 64;
+
+		void beginQuery(int nodeCount);
+		void beginPass();
+		bool improvePath(double weight);
+		void collectQueued();
+		void publish(Path& path, double weight);
+		bool outOfBudget() const;
+		double getG(int node) const;
+		double estimate(int node) const;
+
+		double initialWeight;
+		double weightStep;
+		Limits limits;
+		std::chrono::steady_clock::time_point deadline;
+
+		int width = 0;
+		int startIndex = 0;
+		int goalIndex = 0;
+		std::vector<NodeRecord> records;
+		uint32_t generation = 0;
+		uint32_t pass = 0;
+		IndexedHeap openNodes;
+		// Nodes improved after they were expanded in the current pass; they are queued again in the next one
+		std::vector<int> inconsistentNodes;
+		// Everything still queued at the end of a pass
+		std::vector<int> queuedNodes;
+
+		double bound = 0;
+		double pathCost = 0;
+		size_t expansionCount = 0;
+		size_t generatedCount = 0;
+		bool counting = false;
+		int passCount = 0;
+		size_t allocationCount = 0;
+		size_t allocatedBytes = 0;
+	};
+}
@@ -0,0 +1,357 @@
+#pragma once
+#include "IndexedHeap.h"
+#include "NodeTable.h"
+#include "Path.h"
+#include "SearchPolicies.h"
+
+namespace VulkanProject
+{
+	// A* specialised at compile time: the heuristic, the allowed moves and the cost type are template
+	// parameters (see SearchPolicies.h), so the inner loop has no virtual calls or mode switches left to
+	// take. Like SearchContext it owns scratch tables sized to the grid, sparse ones on a paged grid (see
+	// NodeTable), and only ever reads the grid.
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	class BasicSearch
+	{
+		static_assert(!(std::is_same_v<Heuristic, ManhattanHeuristic> && Connectivity::DIRECTION_COUNT == 8),
+			"Manhattan distance overestimates diagonal moves");
+
+	public:
+		enum class SEARCH_STATE
+		{
+			SEARCHING,
+			FOUND,
+			NOT_FOUND
+		};
+
+		BasicSearch();
+		~BasicSearch();
+		Path generatePath(const int start[2], const int goal[2]);
+		// Resumable form of generatePath: begin() sets up a query, then each step() expands at most
+		// 'maxExpansions' nodes, so a caller can spread one search over several frames
+		void begin(const int start[2], const int goal[2]);
+		SEARCH_STATE step(size_t maxExpansions);
+		SEARCH_STATE getState() const;
+		// The path to the goal once found; while searching, the path to the expanded node closest to the goal
+		Path getPath() const;
+		// Cost of the most recent path in tiles, NodeTable::UNREACHED when none was found
+		double getPathCost() const;
+		// Nodes taken off the open list by the most recent query
+		size_t getExpansionCount() const;
+		// Number of times the scratch tables had to grow, and the bytes they grew by
+		size_t getAllocationCount() const;
+		size_t getAllocatedBytes() const;
+		// Generated nodes and heap operations are only counted while counting is on (see SEARCH_STATS_COUNT)
+		void setCounting(bool counting);
+		// Adds the most recent query's counts
+		void addStats(SearchStats& stats) const;
+
+	private:
+		typedef CostModel<CostType> Costs;
+
+		struct NodeRecord
+		{
+			CostType g;
+			int parent;
+			uint32_t generation;
+			bool closed;
+		};
+
+		void beginQuery(int nodeCount, bool sparse);
+		NodeRecord& recordOf(int node);
+		int getParent(int node) const;
+		void expand(int current, int goalIndex);
+		CostType estimate(int node, int goalIndex) const;
+		void buildSequence(Path& path, int endIndex) const;
+
+		int width = 0;
+		int start[2] = { 0, 0 };
+		int goal[2] = { 0, 0 };
+		int startIndex = 0;
+		int goalIndex = 0;
+		SEARCH_STATE state = SEARCH_STATE::NOT_FOUND;
+		// Expanded node with the smallest estimate so far, the end of the partial path
+		int bestNode = 0;
+		CostType bestEstimate = Costs::UNREACHED;
+		// Same generation trick as NodeTable, but holding g in the search's own cost type
+		std::vector<NodeRecord> records;
+		std::unordered_map<int, NodeRecord> sparseRecords;
+		bool sparse = false;
+		uint32_t generation = 0;
+		IndexedHeap openNodes;
+		CostType pathCost = Costs::UNREACHED;
+		size_t expansionCount = 0;
+		size_t generatedCount = 0;
+		bool counting = false;
+		size_t allocationCount = 0;
+		size_t allocatedBytes = 0;
+	};
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	BasicSearch<Heuristic, Connectivity, CostType>::BasicSearch()
+	{
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	BasicSearch<Heuristic, Connectivity, CostType>::~BasicSearch()
+	{
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	Path BasicSearch<Heuristic, Connectivity, CostType>::generatePath(const int start[2], const int goal[2])
+	{
+		begin(start, goal);
+		bool found = step(std::numeric_limits<size_t>::max()) == SEARCH_STATE::FOUND;
+		if (found)
+		{
+			LOG("Path Found.");
+		}
+		else
+		{
+			LOG("No Path Found.");
+		}
+		return found ? getPath() : Path(start, goal);
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::begin(const int start[2], const int goal[2])
+	{
+		Grid::ensureLoaded();
+		this->start[0] = start[0];
+		this->start[1] = start[1];
+		this->goal[0] = goal[0];
+		this->goal[1] = goal[1];
+		pathCost = Costs::UNREACHED;
+		expansionCount = 0;
+		generatedCount = 0;
+		state = SEARCH_STATE::NOT_FOUND;
+
+		// Every connectivity allows a subset of the moves the grid's region labels are built from
+		if (!Grid::inBounds(start[0], start[1]) || !Grid::inBounds(goal[0], goal[1]) ||
+			!Grid::areConnected(start[0], start[1], goal[0], goal[1]))
+		{
+			// Leaves no heap counts behind from the previous query
+			openNodes.clear();
+			return;
+		}
+
+		width = Grid::getWidth();
+		beginQuery(width * Grid::getHeight(), Grid::isPaged());
+
+		startIndex = Grid::indexOf(start[0], start[1]);
+		goalIndex = Grid::indexOf(goal[0], goal[1]);
+		recordOf(startIndex) = NodeRecord{ 0, startIndex, generation, false };
+		bestNode = startIndex;
+		bestEstimate = estimate(startIndex, goalIndex);
+		openNodes.push(startIndex, (double)bestEstimate, (double)bestEstimate);
+		state = SEARCH_STATE::SEARCHING;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	typename BasicSearch<Heuristic, Connectivity, CostType>::SEARCH_STATE BasicSearch<Heuristic, Connectivity, CostType>::step(size_t maxExpansions)
+	{
+		for (size_t expansions = 0; state == SEARCH_STATE::SEARCHING && expansions < maxExpansions; expansions++)
+		{
+			if (openNodes.empty())
+			{
+				state = SEARCH_STATE::NOT_FOUND;
+				break;
+			}
+
+			// The second key holds the node's estimate
+			int current = openNodes.top();
+			CostType remaining = (CostType)openNodes.getSecondKey(current);
+			openNodes.pop();
+			expansionCount++;
+
+			if (remaining < bestEstimate)
+			{
+				bestNode = current;
+				bestEstimate = remaining;
+			}
+
+			if (current == goalIndex)
+			{
+				pathCost = recordOf(goalIndex).g;
+				state = SEARCH_STATE::FOUND;
+				break;
+			}
+
+			recordOf(current).closed = true;
+			expand(current, goalIndex);
+		}
+		return state;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	typename BasicSearch<Heuristic, Connectivity, CostType>::SEARCH_STATE BasicSearch<Heuristic, Connectivity, CostType>::getState() const
+	{
+		return state;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	Path BasicSearch<Heuristic, Connectivity, CostType>::getPath() const
+	{
+		Path path = Path(start, goal);
+		if (state == SEARCH_STATE::FOUND)
+		{
+			buildSequence(path, goalIndex);
+		}
+		else if (state == SEARCH_STATE::SEARCHING)
+		{
+			buildSequence(path, bestNode);
+		}
+		return path;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	double BasicSearch<Heuristic, Connectivity, CostType>::getPathCost() const
+	{
+		return pathCost == Costs::UNREACHED ? NodeTable::UNREACHED : Costs::toTiles(pathCost);
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	size_t BasicSearch<Heuristic, Connectivity, CostType>::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	size_t BasicSearch<Heuristic, Connectivity, CostType>::getAllocationCount() const
+	{
+		return allocationCount + openNodes.getAllocationCount();
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	size_t BasicSearch<Heuristic, Connectivity, CostType>::getAllocatedBytes() const
+	{
+		return allocatedBytes + openNodes.getAllocatedBytes();
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::setCounting(bool counting)
+	{
+		this->counting = counting;
+		openNodes.setCounting(counting);
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::addStats(SearchStats& stats) const
+	{
+		stats.nodesExpanded += expansionCount;
+		stats.nodesGenerated += generatedCount;
+		openNodes.addStats(stats);
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::beginQuery(int nodeCount, bool sparse)
+	{
+		this->sparse = sparse;
+		openNodes.resize(nodeCount, sparse);
+		if (sparse)
+		{
+			// A fresh map holds no record with the current generation
+			records = std::vector<NodeRecord>();
+			sparseRecords.clear();
+			generation = 1;
+			return;
+		}
+		sparseRecords = std::unordered_map<int, NodeRecord>();
+
+		if ((int)records.size() != nodeCount)
+		{
+			records.assign(nodeCount, NodeRecord{ Costs::UNREACHED, -1, 0, false });
+			generation = 0;
+			allocationCount++;
+			allocatedBytes += nodeCount * sizeof(NodeRecord);
+		}
+
+		generation++;
+		if (generation == 0)
+		{
+			for (NodeRecord& record : records)
+			{
+				record.generation = 0;
+			}
+			generation = 1;
+		}
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	typename BasicSearch<Heuristic, Connectivity, CostType>::NodeRecord& BasicSearch<Heuristic, Connectivity, CostType>::recordOf(int node)
+	{
+		// A node new to the sparse map starts with generation 0, which no query uses
+		return sparse ? sparseRecords[node] : records[node];
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	int BasicSearch<Heuristic, Connectivity, CostType>::getParent(int node) const
+	{
+		return sparse ? sparseRecords.at(node).parent : records[node].parent;
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::expand(int current, int goalIndex)
+	{
+		int currentX = current % width;
+		int currentY = current / width;
+		CostType currentG = recordOf(current).g;
+
+		// Walk the set bits of the move mask instead of testing every direction
+		for (uint32_t moves = Connectivity::allowedMoves(currentX, currentY); moves != 0; moves &= moves - 1)
+		{
+			int direction = std::countr_zero(moves);
+			int neighbor = current + Grid::DIRECTION_Y[direction] * width + Grid::DIRECTION_X[direction];
+			NodeRecord& record = recordOf(neighbor);
+			bool seen = record.generation == generation;
+			SEARCH_STATS_COUNT(counting, generatedCount);
+			if (seen && record.closed)
+			{
+				continue;
+			}
+
+			CostType neighborG = currentG + (direction < 4 ? Costs::ORTHOGONAL : Costs::DIAGONAL);
+			if (seen && neighborG >= record.g)
+			{
+				continue;
+			}
+
+			record = NodeRecord{ neighborG, current, generation, false };
+
+			// Among equal totals, prefer the node closer to the goal
+			CostType remaining = estimate(neighbor, goalIndex);
+			if (seen)
+			{
+				openNodes.decreaseKey(neighbor, (double)(neighborG + remaining), (double)remaining);
+			}
+			else
+			{
+				openNodes.push(neighbor, (double)(neighborG + remaining), (double)remaining);
+			}
+		}
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	CostType BasicSearch<Heuristic, Connectivity, CostType>::estimate(int node, int goalIndex) const
+	{
+		return Heuristic::template estimate<CostType>(abs(node % width - goalIndex % width), abs(node / width - goalIndex / width));
+	}
+
+	template <typename Heuristic, typename Connectivity, typename CostType>
+	void BasicSearch<Heuristic, Connectivity, CostType>::buildSequence(Path& path, int endIndex) const
+	{
+		// Every parent link is a single step, so the path is the parent chain reversed
+		size_t length = 0;
+		for (int node = endIndex; node != startIndex; node = getParent(node))
+		{
+			length++;
+		}
+
+		std::vector<Tile> sequence = std::vector<Tile>(length);
+		for (int node = endIndex; node != startIndex; node = getParent(node))
+		{
+			sequence[--length] = Grid::at(node);
+		}
+		path.setSequence(std::move(sequence));
+	}
+}
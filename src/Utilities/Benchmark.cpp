@@ -0,0 +1,380 @@
+#include "Benchmark.h"
+#include "LandmarkHeuristic.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace VulkanProject
+{
+	const Benchmark::ModeName Benchmark::MODE_NAMES[] =
+	{
+		{ "astar", SearchContext::SEARCH_MODE::A_STAR },
+		{ "jps", SearchContext::SEARCH_MODE::JUMP_POINT },
+		{ "theta", SearchContext::SEARCH_MODE::THETA_STAR },
+		{ "lazy-theta", SearchContext::SEARCH_MODE::LAZY_THETA_STAR },
+		{ "bidirectional", SearchContext::SEARCH_MODE::BIDIRECTIONAL },
+		{ "parallel-bidirectional", SearchContext::SEARCH_MODE::PARALLEL_BIDIRECTIONAL },
+		{ "flow-field", SearchContext::SEARCH_MODE::FLOW_FIELD },
+		{ "landmarks", SearchContext::SEARCH_MODE::LANDMARKS },
+		{ "anytime", SearchContext::SEARCH_MODE::ANYTIME },
+		{ "hpa", SearchContext::SEARCH_MODE::HPA }
+	};
+
+	bool Benchmark::loadMap(const std::string& path)
+	{
+		auto hasExtension = [&](const std::string& extension)
+		{
+			return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+		};
+
+		if (hasExtension(".grid"))
+		{
+			return Grid::loadGridFile(path);
+		}
+
+		int width = 0;
+		int height = 0;
+		std::vector<uint64_t> bits = std::vector<uint64_t>();
+		bool loaded = hasExtension(".map") ? GridFile::readMovingAiMap(path, width, height, bits) : GridFile::readText(path, width, height, bits);
+		if (loaded)
+		{
+			Grid::setGrid(width, height, std::move(bits));
+		}
+		return loaded;
+	}
+
+	bool Benchmark::readScenarios(const std::string& path, std::vector<Scenario>& scenarios)
+	{
+		std::ifstream scenarioFile(path);
+		if (!scenarioFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(scenarioFile, line))
+		{
+			// Skips the "version" header and blank lines
+			std::istringstream fields(line);
+			int bucket = 0;
+			std::string mapName;
+			int mapWidth = 0;
+			int mapHeight = 0;
+			Scenario scenario = Scenario();
+			if (fields >> bucket >> mapName >> mapWidth >> mapHeight >> scenario.start[0] >> scenario.start[1] >>
+				scenario.goal[0] >> scenario.goal[1] >> scenario.optimalLength)
+			{
+				scenarios.push_back(scenario);
+			}
+		}
+
+		if (scenarios.empty())
+		{
+			std::cerr << "ERROR::No scenarios found!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void Benchmark::generateScenarios(int count, unsigned int seed, std::vector<Scenario>& scenarios)
+	{
+		Grid::ensureLoaded();
+		if (Grid::getWidth() == 0 || Grid::getHeight() == 0)
+		{
+			return;
+		}
+
+		// A fixed seed and a fixed generator make the pairs identical on every build and platform
+		std::mt19937 random = std::mt19937(seed);
+		SearchContext::AStar exactSearch = SearchContext::AStar();
+		int attempts = 0;
+		while ((int)scenarios.size() < count && attempts++ < count * 100)
+		{
+			Scenario scenario = Scenario();
+			scenario.start[0] = (int)(random() % (uint32_t)Grid::getWidth());
+			scenario.start[1] = (int)(random() % (uint32_t)Grid::getHeight());
+			scenario.goal[0] = (int)(random() % (uint32_t)Grid::getWidth());
+			scenario.goal[1] = (int)(random() % (uint32_t)Grid::getHeight());
+			if (Grid::isBarrier(scenario.start[0], scenario.start[1]) || Grid::isBarrier(scenario.goal[0], scenario.goal[1]) ||
+				!Grid::areConnected(scenario.start[0], scenario.start[1], scenario.goal[0], scenario.goal[1]))
+			{
+				continue;
+			}
+
+			exactSearch.generatePath(scenario.start, scenario.goal);
+			scenario.optimalLength = exactSearch.getPathCost();
+			scenarios.push_back(scenario);
+		}
+	}
+
+	bool Benchmark::run(const std::string& mapPath, const std::string& scenarioPath, SearchContext::SEARCH_MODE mode, std::ostream& report,
+		unsigned int threadCount)
+	{
+		if (!loadMap(mapPath))
+		{
+			return false;
+		}
+
+		std::vector<Scenario> scenarios = std::vector<Scenario>();
+		if (scenarioPath.empty())
+		{
+			generateScenarios(GENERATED_SCENARIO_COUNT, GENERATED_SCENARIO_SEED, scenarios);
+		}
+		else if (!readScenarios(scenarioPath, scenarios))
+		{
+			return false;
+		}
+
+		// One-off setup stays out of the timings: region labels are built on first use, landmark tables and the HPA abstraction up front
+		Grid::areConnected(0, 0, 0, 0);
+		if (mode == SearchContext::SEARCH_MODE::LANDMARKS)
+		{
+			LandmarkHeuristic::getInstance()->build();
+		}
+		if (mode == SearchContext::SEARCH_MODE::HPA)
+		{
+			// A query that starts on its goal still builds the shared cluster abstraction and this thread's copy of
+			// it, but only from an open tile: a barrier is rejected before the abstraction is looked at
+			for (int tile = 0; tile < Grid::getWidth() * Grid::getHeight(); tile++)
+			{
+				Tile open = Grid::at(tile);
+				if (!open.isBarrier())
+				{
+					int origin[2] = { open.getX(), open.getY() };
+					Search::generatePath(origin, origin, mode);
+					break;
+				}
+			}
+		}
+
+		// Scenario files come with optimal lengths under Moving AI's rules, which only plain A* can switch to
+		bool noCornerCutting = !scenarioPath.empty() && mode == SearchContext::SEARCH_MODE::A_STAR;
+		NoCornerCuttingAStar noCornerCuttingSearch = NoCornerCuttingAStar();
+
+		// Only scenarios that repeat within the run may hit the path cache
+		PathCache* pathCache = Search::getPathCache();
+		pathCache->clear();
+		size_t cacheHits = pathCache->getHitCount();
+		size_t cacheMisses = pathCache->getMissCount();
+		size_t cacheEvictions = pathCache->getEvictionCount();
+
+		std::vector<double> latencies = std::vector<double>();
+		std::vector<PathQuery> batchQueries = std::vector<PathQuery>();
+		size_t expansions = 0;
+		size_t solved = 0;
+		size_t skipped = 0;
+		size_t shorter = 0;
+		size_t longer = 0;
+		double errorSum = 0;
+		double maxError = 0;
+		for (Scenario& scenario : scenarios)
+		{
+			if (!Grid::inBounds(scenario.start[0], scenario.start[1]) || !Grid::inBounds(scenario.goal[0], scenario.goal[1]))
+			{
+				skipped++;
+				continue;
+			}
+			batchQueries.push_back(PathQuery{ { scenario.start[0], scenario.start[1] }, { scenario.goal[0], scenario.goal[1] } });
+
+			std::chrono::steady_clock::time_point queryStart = std::chrono::steady_clock::now();
+			Path path = noCornerCutting ? noCornerCuttingSearch.generatePath(scenario.start, scenario.goal) :
+				Search::generatePath(scenario.start, scenario.goal, mode);
+			latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStart).count());
+			expansions += noCornerCutting ? noCornerCuttingSearch.getExpansionCount() : Search::getExpansionCount();
+
+			double length = measurePath(path, scenario.start);
+			bool found = length >= 0 && (path.getSequence().empty() ?
+				scenario.start[0] == scenario.goal[0] && scenario.start[1] == scenario.goal[1] :
+				path.getSequence().back().getX() == scenario.goal[0] && path.getSequence().back().getY() == scenario.goal[1]);
+			if (!found)
+			{
+				continue;
+			}
+
+			// Relative error against the optimum; tiny differences are rounding in the scenario file
+			solved++;
+			double error = scenario.optimalLength > 0 ? (length - scenario.optimalLength) / scenario.optimalLength : 0;
+			shorter += error < -1e-6;
+			longer += error > 1e-6;
+			errorSum += error;
+			maxError = std::max(maxError, std::abs(error));
+		}
+
+		double totalMilliseconds = 0;
+		for (double latency : latencies)
+		{
+			totalMilliseconds += latency;
+		}
+		std::sort(latencies.begin(), latencies.end());
+
+		// Throughput of the same queries across threads, to compare with the single-threaded total above; the batch
+		// always uses the engine's rules
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		// Emptied again so the batch searches the queries rather than replaying the results above
+		pathCache->clear();
+		std::vector<Path> batchResults = std::vector<Path>(batchQueries.size());
+		std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+		Search::generatePaths(batchQueries, batchResults, threadCount, mode);
+		double batchMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+		cacheHits = pathCache->getHitCount() - cacheHits;
+		cacheMisses = pathCache->getMissCount() - cacheMisses;
+		cacheEvictions = pathCache->getEvictionCount() - cacheEvictions;
+
+		// Edit then replan: block the middle of an agent's path and compare the D* Lite repair with A* from scratch
+		size_t replans = 0;
+		size_t incrementalExpansions = 0;
+		size_t scratchExpansions = 0;
+		size_t replanMismatches = 0;
+		double incrementalMilliseconds = 0;
+		double scratchMilliseconds = 0;
+		SearchContext::AStar scratchSearch = SearchContext::AStar();
+		for (const PathQuery& query : batchQueries)
+		{
+			if (replans == REPLAN_SCENARIO_COUNT)
+			{
+				break;
+			}
+			Path plan = Search::replan(REPLAN_AGENT, query.start, query.goal);
+			const std::vector<Tile>& planned = plan.getSequence();
+			if (planned.size() < 3 || planned.back().getX() != query.goal[0] || planned.back().getY() != query.goal[1])
+			{
+				continue;
+			}
+
+			Tile blocked = planned[planned.size() / 2];
+			Grid::setBarrier(blocked.getX(), blocked.getY(), true);
+
+			std::chrono::steady_clock::time_point replanStart = std::chrono::steady_clock::now();
+			Path repaired = Search::replan(REPLAN_AGENT, query.start, query.goal);
+			incrementalMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replanStart).count();
+			incrementalExpansions += Search::getAgentExpansionCount(REPLAN_AGENT);
+
+			replanStart = std::chrono::steady_clock::now();
+			scratchSearch.generatePath(query.start, query.goal);
+			scratchMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replanStart).count();
+			scratchExpansions += scratchSearch.getExpansionCount();
+
+			// Both are exact, so their costs agree whenever the repair is right
+			const std::vector<Tile>& repairedSequence = repaired.getSequence();
+			bool repairedFound = !repairedSequence.empty() && repairedSequence.back().getX() == query.goal[0] &&
+				repairedSequence.back().getY() == query.goal[1];
+			double repairedLength = repairedFound ? measurePath(repaired, query.start) : NodeTable::UNREACHED;
+			double scratchLength = scratchSearch.getPathCost();
+			bool unreached = repairedLength == NodeTable::UNREACHED || scratchLength == NodeTable::UNREACHED;
+			replanMismatches += unreached ? repairedLength != scratchLength : std::abs(repairedLength - scratchLength) > 1e-6;
+
+			Grid::setBarrier(blocked.getX(), blocked.getY(), false);
+			replans++;
+		}
+		Search::forgetAgent(REPLAN_AGENT);
+
+		report << std::setprecision(6);
+		report << "{\n";
+		report << "  \"map\": ";
+		writeString(report, mapPath);
+		report << ",\n  \"scenarios\": ";
+		writeString(report, scenarioPath.empty() ? "generated" : scenarioPath);
+		report << ",\n  \"mode\": ";
+		writeString(report, getModeName(mode));
+		report << ",\n  \"moveRules\": ";
+		writeString(report, noCornerCutting ? "no-corner-cutting" : "corner-cutting");
+		report << ",\n  \"width\": " << Grid::getWidth() << ",\n  \"height\": " << Grid::getHeight() << ",\n";
+		report << "  \"queries\": " << latencies.size() << ",\n  \"solved\": " << solved << ",\n  \"skipped\": " << skipped << ",\n";
+		report << "  \"expansions\": " << expansions << ",\n";
+		report << "  \"expansionsPerSecond\": " << (totalMilliseconds > 0 ? expansions / (totalMilliseconds / 1000.0) : 0) << ",\n";
+		report << "  \"latencyMs\": { \"total\": " << totalMilliseconds << ", \"mean\": " << (latencies.empty() ? 0 : totalMilliseconds / latencies.size()) <<
+			", \"p50\": " << percentile(latencies, 0.50) << ", \"p95\": " << percentile(latencies, 0.95) <<
+			", \"p99\": " << percentile(latencies, 0.99) << ", \"max\": " << percentile(latencies, 1.0) << " },\n";
+		report << "  \"costError\": { \"mean\": " << (solved > 0 ? errorSum / solved : 0) << ", \"maxAbsolute\": " << maxError <<
+			", \"shorterThanOptimal\": " << shorter << ", \"longerThanOptimal\": " << longer << " },\n";
+		report << "  \"batch\": { \"threads\": " << threadCount << ", \"totalMs\": " << batchMilliseconds <<
+			", \"queriesPerSecond\": " << (batchMilliseconds > 0 ? batchQueries.size() / (batchMilliseconds / 1000.0) : 0) <<
+			", \"speedup\": " << (batchMilliseconds > 0 ? totalMilliseconds / batchMilliseconds : 0) <<
+			", \"stolen\": " << WorkStealingPool::getInstance()->getStolenCount() << " },\n";
+		report << "  \"pathCache\": { \"hits\": " << cacheHits << ", \"misses\": " << cacheMisses <<
+			", \"evictions\": " << cacheEvictions << " },\n";
+		report << "  \"replan\": { \"scenarios\": " << replans << ", \"incrementalExpansions\": " << incrementalExpansions <<
+			", \"fromScratchExpansions\": " << scratchExpansions << ", \"incrementalMs\": " << incrementalMilliseconds <<
+			", \"fromScratchMs\": " << scratchMilliseconds << ", \"costMismatches\": " << replanMismatches << " }\n";
+		report << "}" << std::endl;
+		return true;
+	}
+
+	bool Benchmark::parseMode(const std::string& name, SearchContext::SEARCH_MODE& mode)
+	{
+		for (const ModeName& modeName : MODE_NAMES)
+		{
+			if (name == modeName.name)
+			{
+				mode = modeName.mode;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char* Benchmark::getModeName(SearchContext::SEARCH_MODE mode)
+	{
+		for (const ModeName& modeName : MODE_NAMES)
+		{
+			if (mode == modeName.mode)
+			{
+				return modeName.name;
+			}
+		}
+		return "unknown";
+	}
+
+	double Benchmark::measurePath(const Path& path, const int start[2])
+	{
+		// Straight segments between consecutive tiles, which also covers any-angle waypoints; -1 if the path steps onto a barrier
+		double length = 0;
+		int previous[2] = { start[0], start[1] };
+		for (const Tile& tile : path.getSequence())
+		{
+			if (Grid::isBarrier(tile.getX(), tile.getY()))
+			{
+				return -1;
+			}
+			double dx = tile.getX() - previous[0];
+			double dy = tile.getY() - previous[1];
+			length += sqrt(dx * dx + dy * dy);
+			previous[0] = tile.getX();
+			previous[1] = tile.getY();
+		}
+		return length;
+	}
+
+	double Benchmark::percentile(const std::vector<double>& sortedValues, double fraction)
+	{
+		// Nearest-rank percentile
+		if (sortedValues.empty())
+		{
+			return 0;
+		}
+		size_t rank = (size_t)std::ceil(fraction * sortedValues.size());
+		return sortedValues[std::clamp<size_t>(rank, 1, sortedValues.size()) - 1];
+	}
+
+	void Benchmark::writeString(std::ostream& report, const std::string& value)
+	{
+		// Windows paths are full of backslashes
+		report << '"';
+		for (char character : value)
+		{
+			if (character == '"' || character == '\\')
+			{
+				report << '\\';
+			}
+			report << character;
+		}
+		report << '"';
+	}
+}
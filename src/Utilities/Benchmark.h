@@ -0,0 +1,66 @@
+#pragma once
+#include "Search.h"
+#include <ostream>
+#include <string>
+
+namespace VulkanProject
+{
+	// Reproducible performance runs on Moving AI benchmark maps and scenarios. Every scenario goes through
+	// Search::generatePath and the run is summarised as a single JSON object (expansions, latency percentiles,
+	// cost error against the scenario's optimal length, batch throughput), so reports from different builds can be diffed.
+	// Moving AI's optimal lengths forbid cutting corners while this engine allows it. With a scenario file, astar
+	// therefore runs NoCornerCuttingAStar one query at a time so its cost error is against matching rules; the
+	// other modes keep the engine's rules, where a negative cost error is expected and not a bug. The report's
+	// "moveRules" says which rules the single queries used.
+	class Benchmark
+	{
+	public:
+		// Plain A* under Moving AI's move rules
+		typedef BasicSearch<OctileHeuristic, EightConnectedNoCornerCutting, double> NoCornerCuttingAStar;
+
+		struct Scenario
+		{
+			int start[2];
+			int goal[2];
+			double optimalLength;
+		};
+
+		// Loads a Moving AI .map, a binary .grid or the Barriers.txt text format, chosen by extension
+		static bool loadMap(const std::string& path);
+		// Reads a Moving AI .scen file ("version 1" header, then bucket, map, map size, start, goal, optimal length)
+		static bool readScenarios(const std::string& path, std::vector<Scenario>& scenarios);
+		// Reproducible start/goal pairs on the loaded grid for maps without a scenario file, with optimal
+		// lengths measured by an exact A* under this engine's move rules
+		static void generateScenarios(int count, unsigned int seed, std::vector<Scenario>& scenarios);
+		// An empty scenario path runs generated scenarios instead. After timing the queries one by one, the run
+		// solves them again as one Search::generatePaths batch on threadCount threads (0 = one per hardware thread).
+		// The path cache is emptied before each of the two, and its hits, misses and evictions over both are reported.
+		// Finally, for up to REPLAN_SCENARIO_COUNT of them, it blocks the middle of a Search::replan path and times
+		// the replan against A* from scratch, undoing each edit afterwards.
+		static bool run(const std::string& mapPath, const std::string& scenarioPath, SearchContext::SEARCH_MODE mode, std::ostream& report,
+			unsigned int threadCount = 0);
+		// Accepts the names used on the command line: astar, jps, theta, lazy-theta, bidirectional,
+		// parallel-bidirectional, flow-field, landmarks, anytime and hpa
+		static bool parseMode(const std::string& name, SearchContext::SEARCH_MODE& mode);
+
+		static const int GENERATED_SCENARIO_COUNT = 1000;
+		static const unsigned int GENERATED_SCENARIO_SEED = 12345;
+		static const size_t REPLAN_SCENARIO_COUNT = 100;
+
+	private:
+		struct ModeName
+		{
+			const char* name;
+			SearchContext::SEARCH_MODE mode;
+		};
+
+		static const ModeName MODE_NAMES[];
+		// Search::replan agent id used by the edit-then-replan runs
+		static const int REPLAN_AGENT = 0;
+
+		static const char* getModeName(SearchContext::SEARCH_MODE mode);
+		static double measurePath(const Path& path, const int start[2]);
+		static double percentile(const std::vector<double>& sortedValues, double fraction);
+		static void writeString(std::ostream& report, const std::string& value);
+	};
+}
@@ -0,0 +1,297 @@
+#include "BidirectionalSearch.h"
+#include <thread>
+
+namespace VulkanProject
+{
+	BidirectionalSearch::BidirectionalSearch()
+	{
+		bestCost = NodeTable::UNREACHED;
+		finished = false;
+	}
+
+	BidirectionalSearch::~BidirectionalSearch()
+	{
+	}
+
+	Path BidirectionalSearch::generatePath(const int start[2], const int goal[2], bool parallel)
+	{
+		Path path = Path(start, goal);
+
+		// Make sure the barrier file has been loaded before indexing into the grid
+		Grid::ensureLoaded();
+
+		forward.expansionCount = 0;
+		backward.expansionCount = 0;
+		forward.generatedCount = 0;
+		backward.generatedCount = 0;
+		if (!Grid::inBounds(start[0], start[1]) || !Grid::inBounds(goal[0], goal[1]))
+		{
+			LOG("No Path Found.");
+			forward.openNodes.clear();
+			backward.openNodes.clear();
+			return path;
+		}
+
+		int startIndex = Grid::indexOf(start[0], start[1]);
+		int goalIndex = Grid::indexOf(goal[0], goal[1]);
+
+		bestCost = NodeTable::UNREACHED;
+		meetingNode = -1;
+		finished = false;
+		beginFrontier(forward, startIndex, goal[0], goal[1], parallel);
+		beginFrontier(backward, goalIndex, start[0], start[1], parallel);
+		if (startIndex == goalIndex)
+		{
+			offerMeeting(startIndex, 0);
+		}
+
+		if (parallel)
+		{
+			std::thread backwardThread = std::thread([this]() { runFrontier(backward, forward); });
+			runFrontier(forward, backward);
+			backwardThread.join();
+		}
+		else
+		{
+			while (!forward.openNodes.empty() && !backward.openNodes.empty())
+			{
+				// Either frontier's lowest f bounds every path not yet joined, so one of them is enough to stop
+				if (std::max(getLowestF(forward), getLowestF(backward)) >= bestCost)
+				{
+					break;
+				}
+
+				// Grow whichever frontier is currently smaller
+				if (forward.openNodes.size() <= backward.openNodes.size())
+				{
+					expand(forward, backward, false);
+				}
+				else
+				{
+					expand(backward, forward, false);
+				}
+			}
+		}
+
+		if (meetingNode < 0)
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		LOG("Path Found.");
+		buildSequence(path, startIndex, goalIndex);
+		return path;
+	}
+
+	size_t BidirectionalSearch::getExpansionCount() const
+	{
+		return forward.expansionCount + backward.expansionCount;
+	}
+
+	size_t BidirectionalSearch::getAllocationCount() const
+	{
+		return forward.nodes.getAllocationCount() + forward.openNodes.getAllocationCount() +
+			backward.nodes.getAllocationCount() + backward.openNodes.getAllocationCount();
+	}
+
+	size_t BidirectionalSearch::getAllocatedBytes() const
+	{
+		return forward.nodes.getAllocatedBytes() + forward.openNodes.getAllocatedBytes() +
+			backward.nodes.getAllocatedBytes() + backward.openNodes.getAllocatedBytes();
+	}
+
+	void BidirectionalSearch::setCounting(bool counting)
+	{
+		this->counting = counting;
+		forward.openNodes.setCounting(counting);
+		backward.openNodes.setCounting(counting);
+	}
+
+	void BidirectionalSearch::addStats(SearchStats& stats) const
+	{
+		stats.nodesExpanded += forward.expansionCount + backward.expansionCount;
+		stats.nodesGenerated += forward.generatedCount + backward.generatedCount;
+		forward.openNodes.addStats(stats);
+		backward.openNodes.addStats(stats);
+	}
+
+	void BidirectionalSearch::beginFrontier(Frontier& frontier, int sourceIndex, int targetX, int targetY, bool parallel)
+	{
+		int nodeCount = Grid::getWidth() * Grid::getHeight();
+		frontier.nodes.beginQuery(nodeCount);
+		frontier.openNodes.resize(nodeCount);
+		frontier.targetX = targetX;
+		frontier.targetY = targetY;
+
+		if (parallel)
+		{
+			if ((int)frontier.publishedStamps.size() != nodeCount)
+			{
+				frontier.publishedG = std::vector<std::atomic<double>>(nodeCount);
+				frontier.publishedStamps = std::vector<std::atomic<uint32_t>>(nodeCount);
+				frontier.publishedGeneration = 0;
+			}
+
+			// Same trick as NodeTable: a new generation hides every earlier entry
+			frontier.publishedGeneration++;
+			if (frontier.publishedGeneration == 0)
+			{
+				for (std::atomic<uint32_t>& stamp : frontier.publishedStamps)
+				{
+					stamp = 0;
+				}
+				frontier.publishedGeneration = 1;
+			}
+		}
+
+		frontier.nodes.open(sourceIndex, 0, NodeTable::NO_PARENT);
+		frontier.openNodes.push(sourceIndex, estimateDistance(frontier, sourceIndex));
+		if (parallel)
+		{
+			frontier.publishedG[sourceIndex].store(0, std::memory_order_relaxed);
+			frontier.publishedStamps[sourceIndex].store(frontier.publishedGeneration);
+		}
+	}
+
+	void BidirectionalSearch::expand(Frontier& self, Frontier& other, bool parallel)
+	{
+		int currentIndex = self.openNodes.pop();
+		self.expansionCount++;
+		self.nodes.close(currentIndex);
+
+		double currentG = self.nodes.getG(currentIndex);
+		int currentX = currentIndex % Grid::getWidth();
+		int currentY = currentIndex / Grid::getWidth();
+		for (Tile neighbor : Grid::neighbors(currentX, currentY))
+		{
+			int neighborIndex = Grid::indexOf(neighbor.getX(), neighbor.getY());
+			NodeTable::NodeState state = self.nodes.getState(neighborIndex);
+			SEARCH_STATS_COUNT(counting, self.generatedCount);
+			if (state == NodeTable::NodeState::CLOSED)
+			{
+				continue;
+			}
+
+			// Orthogonal steps cost 1, diagonal steps cost sqrt(2)
+			double stepCost = (neighbor.getX() != currentX && neighbor.getY() != currentY) ? sqrt(2.0) : 1.0;
+			double neighborG = currentG + stepCost;
+			if (neighborG >= self.nodes.getG(neighborIndex))
+			{
+				continue;
+			}
+
+			self.nodes.open(neighborIndex, neighborG, currentIndex);
+			if (parallel)
+			{
+				// Value first, then the stamp that makes it visible to the other thread
+				self.publishedG[neighborIndex].store(neighborG, std::memory_order_relaxed);
+				self.publishedStamps[neighborIndex].store(self.publishedGeneration);
+			}
+
+			double neighborF = neighborG + estimateDistance(self, neighborIndex);
+			if (state == NodeTable::NodeState::OPEN)
+			{
+				self.openNodes.decreaseKey(neighborIndex, neighborF);
+			}
+			else
+			{
+				self.openNodes.push(neighborIndex, neighborF);
+			}
+
+			double otherG = getOtherG(other, neighborIndex, parallel);
+			if (otherG != NodeTable::UNREACHED)
+			{
+				offerMeeting(neighborIndex, neighborG + otherG);
+			}
+		}
+	}
+
+	void BidirectionalSearch::runFrontier(Frontier& self, Frontier& other)
+	{
+		while (!finished)
+		{
+			// This frontier alone proves the best meeting optimal once its lowest f reaches it
+			if (self.openNodes.empty() || getLowestF(self) >= bestCost)
+			{
+				finished = true;
+				break;
+			}
+			expand(self, other, true);
+		}
+	}
+
+	double BidirectionalSearch::getOtherG(const Frontier& other, int node, bool parallel) const
+	{
+		if (!parallel)
+		{
+			return other.nodes.getG(node);
+		}
+		if (other.publishedStamps[node].load() != other.publishedGeneration)
+		{
+			return NodeTable::UNREACHED;
+		}
+		return other.publishedG[node].load(std::memory_order_relaxed);
+	}
+
+	void BidirectionalSearch::offerMeeting(int node, double cost)
+	{
+		if (cost >= bestCost)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(meetingMutex);
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			meetingNode = node;
+		}
+	}
+
+	double BidirectionalSearch::getLowestF(const Frontier& frontier) const
+	{
+		return frontier.openNodes.getKey(frontier.openNodes.top());
+	}
+
+	double BidirectionalSearch::estimateDistance(const Frontier& frontier, int node) const
+	{
+		// Straight-line distance to the tile this frontier is heading for
+		double dx = frontier.targetX - node % Grid::getWidth();
+		double dy = frontier.targetY - node / Grid::getWidth();
+		return sqrt(dx * dx + dy * dy);
+	}
+
+	void BidirectionalSearch::buildSequence(Path& path, int startIndex, int goalIndex)
+	{
+		// Both frontiers may still hold better parents than when the meeting was recorded, which only shortens the result
+		size_t forwardLength = 0;
+		for (int node = meetingNode; node != startIndex; node = forward.nodes.getParent(node))
+		{
+			forwardLength++;
+		}
+		size_t backwardLength = 0;
+		for (int node = meetingNode; node != goalIndex; node = backward.nodes.getParent(node))
+		{
+			backwardLength++;
+		}
+
+		std::vector<Tile> sequence = std::vector<Tile>(forwardLength + backwardLength);
+
+		// Start side: fill back to front up to and including the meeting tile
+		size_t position = forwardLength;
+		for (int node = meetingNode; node != startIndex; node = forward.nodes.getParent(node))
+		{
+			sequence[--position] = Grid::at(node);
+		}
+
+		// Goal side: the backward parents already point towards the goal
+		position = forwardLength;
+		for (int node = meetingNode; node != goalIndex; )
+		{
+			node = backward.nodes.getParent(node);
+			sequence[position++] = Grid::at(node);
+		}
+		path.setSequence(std::move(sequence));
+	}
+}
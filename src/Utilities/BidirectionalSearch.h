@@ -0,0 +1,65 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "NodeTable.h"
+#include "Path.h"
+#include <atomic>
+#include <mutex>
+
+namespace VulkanProject
+{
+	// Bidirectional A*: one frontier grows from the start towards the goal and another from the goal towards
+	// the start, each guided by its own consistent heuristic. Every time a frontier reaches a tile the other
+	// has already seen, the joined cost becomes a candidate. The search stops once either frontier's lowest
+	// f-value reaches the best candidate, which proves it optimal.
+	class BidirectionalSearch
+	{
+	public:
+		BidirectionalSearch();
+		~BidirectionalSearch();
+		// With 'parallel' set the backward frontier runs on a second thread
+		Path generatePath(const int start[2], const int goal[2], bool parallel);
+		size_t getExpansionCount() const;
+		size_t getAllocationCount() const;
+		size_t getAllocatedBytes() const;
+		// Generated nodes and heap operations are only counted while counting is on (see SEARCH_STATS_COUNT)
+		void setCounting(bool counting);
+		// Adds both frontiers' counts
+		void addStats(SearchStats& stats) const;
+
+	private:
+		struct Frontier
+		{
+			NodeTable nodes;
+			IndexedHeap openNodes;
+			int targetX = 0;
+			int targetY = 0;
+			size_t expansionCount = 0;
+			size_t generatedCount = 0;
+			// Copy of the g-values that the other thread may read while this frontier is still growing.
+			// An entry only counts when its stamp matches 'publishedGeneration'.
+			std::vector<std::atomic<double>> publishedG;
+			std::vector<std::atomic<uint32_t>> publishedStamps;
+			uint32_t publishedGeneration = 0;
+		};
+
+		void beginFrontier(Frontier& frontier, int sourceIndex, int targetX, int targetY, bool parallel);
+		void expand(Frontier& self, Frontier& other, bool parallel);
+		void runFrontier(Frontier& self, Frontier& other);
+		double getOtherG(const Frontier& other, int node, bool parallel) const;
+		void offerMeeting(int node, double cost);
+		double getLowestF(const Frontier& frontier) const;
+		double estimateDistance(const Frontier& frontier, int node) const;
+		void buildSequence(Path& path, int startIndex, int goalIndex);
+
+		Frontier forward;
+		Frontier backward;
+		bool counting = false;
+
+		// Best start-to-goal cost found through a meeting tile so far
+		std::mutex meetingMutex;
+		std::atomic<double> bestCost;
+		int meetingNode = -1;
+		std::atomic<bool> finished;
+	};
+}
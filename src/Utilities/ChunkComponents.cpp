@@ -0,0 +1,357 @@
+#include "ChunkComponents.h"
+#include "Grid.h"
+
+namespace VulkanProject
+{
+	ChunkComponents::ChunkComponents()
+	{
+	}
+
+	ChunkComponents::~ChunkComponents()
+	{
+	}
+
+	void ChunkComponents::reset(GridPager* pager, int width, int height, int chunkSize)
+	{
+		this->pager = pager;
+		this->width = width;
+		this->height = height;
+		this->chunkSize = chunkSize;
+		chunkColumns = (width + chunkSize - 1) / chunkSize;
+		chunks = std::vector<Chunk>((size_t)chunkColumns * ((height + chunkSize - 1) / chunkSize));
+		stale = true;
+		componentParents = std::vector<int>();
+		componentRanks = std::vector<uint8_t>();
+		for (Labelling& labelling : labellings)
+		{
+			labelling = Labelling();
+		}
+		useCount = 0;
+	}
+
+	bool ChunkComponents::areConnected(int fromX, int fromY, int toX, int toY)
+	{
+		refresh();
+
+		int fromChunk = chunkOf(fromX, fromY);
+		const Labelling& from = getLabelling(fromChunk);
+		int fromLabel = from.labels[(fromY % chunkSize) * chunkWidth(fromChunk) + fromX % chunkSize];
+		int fromComponent = from.components[fromLabel];
+
+		// Cached labellings are only replaced oldest first, so 'from' is still valid after this
+		int toChunk = chunkOf(toX, toY);
+		const Labelling& to = getLabelling(toChunk);
+		int toLabel = to.labels[(toY % chunkSize) * chunkWidth(toChunk) + toX % chunkSize];
+		int toComponent = to.components[toLabel];
+
+		if (fromChunk == toChunk && fromLabel == toLabel)
+		{
+			return true;
+		}
+		// A region that never reaches its chunk's border cannot reach anything outside it
+		if (fromComponent < 0 || toComponent < 0)
+		{
+			return false;
+		}
+		return findComponent(fromComponent) == findComponent(toComponent);
+	}
+
+	void ChunkComponents::markEdited(int x, int y)
+	{
+		int chunk = chunkOf(x, y);
+		chunks[chunk].edited = true;
+		stale = true;
+	}
+
+	void ChunkComponents::refresh()
+	{
+		if (!stale)
+		{
+			return;
+		}
+
+		int componentCount = 0;
+		for (int chunk = 0; chunk < (int)chunks.size(); chunk++)
+		{
+			if (chunks[chunk].edited)
+			{
+				buildChunk(chunk);
+			}
+			chunks[chunk].firstComponent = componentCount;
+			componentCount += chunks[chunk].componentCount;
+		}
+
+		componentParents.resize(componentCount);
+		componentRanks.assign(componentCount, 0);
+		for (int component = 0; component < componentCount; component++)
+		{
+			componentParents[component] = component;
+		}
+
+		// Join every border region to the regions of the tiles it touches in neighbouring chunks
+		for (int chunk = 0; chunk < (int)chunks.size(); chunk++)
+		{
+			int originX = (chunk % chunkColumns) * chunkSize;
+			int originY = (chunk / chunkColumns) * chunkSize;
+			for (int edge = 0; edge < EDGE_COUNT; edge++)
+			{
+				const std::vector<EdgeRun>& runs = chunks[chunk].edges[edge];
+				int length = edge == TOP || edge == BOTTOM ? chunkWidth(chunk) : chunkHeight(chunk);
+				for (size_t run = 0; run < runs.size(); run++)
+				{
+					if (runs[run].component < 0)
+					{
+						continue;
+					}
+
+					int component = chunks[chunk].firstComponent + runs[run].component;
+					int end = run + 1 < runs.size() ? runs[run + 1].start : length;
+					for (int position = runs[run].start; position < end; position++)
+					{
+						int x = originX + (edge == TOP || edge == BOTTOM ? position : (edge == LEFT ? 0 : chunkWidth(chunk) - 1));
+						int y = originY + (edge == LEFT || edge == RIGHT ? position : (edge == TOP ? 0 : chunkHeight(chunk) - 1));
+						for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+						{
+							int neighborX = x + Grid::DIRECTION_X[direction];
+							int neighborY = y + Grid::DIRECTION_Y[direction];
+							if (neighborX < 0 || neighborY < 0 || neighborX >= width || neighborY >= height ||
+								chunkOf(neighborX, neighborY) == chunk)
+							{
+								continue;
+							}
+							int neighborComponent = getBorderComponent(neighborX, neighborY);
+							if (neighborComponent >= 0)
+							{
+								mergeComponents(component, neighborComponent);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// Cached labellings hold union-find ids, which were all just renumbered
+		for (Labelling& labelling : labellings)
+		{
+			labelling.chunk = -1;
+		}
+		stale = false;
+	}
+
+	void ChunkComponents::buildChunk(int chunk)
+	{
+		std::vector<int> labels = std::vector<int>();
+		int labelCount = labelChunk(chunk, labels);
+		int chunkW = chunkWidth(chunk);
+		int chunkH = chunkHeight(chunk);
+
+		// Border regions are numbered in the order the edges meet them
+		std::vector<int> borderComponents = std::vector<int>(labelCount, -1);
+		Chunk& entry = chunks[chunk];
+		entry.componentCount = 0;
+		for (int edge = 0; edge < EDGE_COUNT; edge++)
+		{
+			std::vector<EdgeRun>& runs = entry.edges[edge];
+			runs.clear();
+			int length = edge == TOP || edge == BOTTOM ? chunkW : chunkH;
+			for (int position = 0; position < length; position++)
+			{
+				int x = edge == TOP || edge == BOTTOM ? position : (edge == LEFT ? 0 : chunkW - 1);
+				int y = edge == LEFT || edge == RIGHT ? position : (edge == TOP ? 0 : chunkH - 1);
+				int label = labels[y * chunkW + x];
+				int component = -1;
+				if (label >= 0)
+				{
+					if (borderComponents[label] < 0)
+					{
+						borderComponents[label] = entry.componentCount++;
+					}
+					component = borderComponents[label];
+				}
+				if (runs.empty() || runs.back().component != component)
+				{
+					runs.push_back(EdgeRun{ position, component });
+				}
+			}
+			runs.shrink_to_fit();
+		}
+		entry.edited = false;
+	}
+
+	int ChunkComponents::labelChunk(int chunk, std::vector<int>& labels)
+	{
+		int originX = (chunk % chunkColumns) * chunkSize;
+		int originY = (chunk / chunkColumns) * chunkSize;
+		int chunkW = chunkWidth(chunk);
+		int chunkH = chunkHeight(chunk);
+
+		// One page-in per row of words rather than one per tile
+		int rowWords = (chunkW + 63) / 64;
+		chunkBits.resize((size_t)chunkH * rowWords);
+		for (int y = 0; y < chunkH; y++)
+		{
+			for (int word = 0; word < rowWords; word++)
+			{
+				chunkBits[(size_t)y * rowWords + word] = pager->getWord(originY + y, originX / 64 + word);
+			}
+		}
+
+		labels.assign((size_t)chunkW * chunkH, -1);
+		int labelCount = 0;
+		for (int y = 0; y < chunkH; y++)
+		{
+			for (int x = 0; x < chunkW; x++)
+			{
+				if (labels[y * chunkW + x] != -1 || (chunkBits[(size_t)y * rowWords + x / 64] >> (x % 64)) & 1)
+				{
+					continue;
+				}
+
+				int label = labelCount++;
+				labels[y * chunkW + x] = label;
+				stack.push_back(y * chunkW + x);
+				while (!stack.empty())
+				{
+					int tile = stack.back();
+					stack.pop_back();
+					int tileX = tile % chunkW;
+					int tileY = tile / chunkW;
+					for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+					{
+						int neighborX = tileX + Grid::DIRECTION_X[direction];
+						int neighborY = tileY + Grid::DIRECTION_Y[direction];
+						if (neighborX >= 0 && neighborY >= 0 && neighborX < chunkW && neighborY < chunkH &&
+							labels[neighborY * chunkW + neighborX] == -1 &&
+							!((chunkBits[(size_t)neighborY * rowWords + neighborX / 64] >> (neighborX % 64)) & 1))
+						{
+							labels[neighborY * chunkW + neighborX] = label;
+							stack.push_back(neighborY * chunkW + neighborX);
+						}
+					}
+				}
+			}
+		}
+		return labelCount;
+	}
+
+	const ChunkComponents::Labelling& ChunkComponents::getLabelling(int chunk)
+	{
+		Labelling* oldest = &labellings[0];
+		for (Labelling& labelling : labellings)
+		{
+			if (labelling.chunk == chunk)
+			{
+				labelling.lastUse = ++useCount;
+				return labelling;
+			}
+			if (labelling.lastUse < oldest->lastUse)
+			{
+				oldest = &labelling;
+			}
+		}
+
+		// Labels come out the same as when the chunk's edges were built, as nothing changed since
+		int labelCount = labelChunk(chunk, oldest->labels);
+		oldest->components.assign(labelCount, -1);
+		int originX = (chunk % chunkColumns) * chunkSize;
+		int originY = (chunk / chunkColumns) * chunkSize;
+		int chunkW = chunkWidth(chunk);
+		int chunkH = chunkHeight(chunk);
+		for (int x = 0; x < chunkW; x++)
+		{
+			for (int y : { 0, chunkH - 1 })
+			{
+				int label = oldest->labels[y * chunkW + x];
+				if (label >= 0)
+				{
+					oldest->components[label] = getBorderComponent(originX + x, originY + y);
+				}
+			}
+		}
+		for (int y = 0; y < chunkH; y++)
+		{
+			for (int x : { 0, chunkW - 1 })
+			{
+				int label = oldest->labels[y * chunkW + x];
+				if (label >= 0)
+				{
+					oldest->components[label] = getBorderComponent(originX + x, originY + y);
+				}
+			}
+		}
+		oldest->chunk = chunk;
+		oldest->lastUse = ++useCount;
+		return *oldest;
+	}
+
+	int ChunkComponents::chunkOf(int x, int y) const
+	{
+		return (y / chunkSize) * chunkColumns + x / chunkSize;
+	}
+
+	int ChunkComponents::chunkWidth(int chunk) const
+	{
+		return std::min(chunkSize, width - (chunk % chunkColumns) * chunkSize);
+	}
+
+	int ChunkComponents::chunkHeight(int chunk) const
+	{
+		return std::min(chunkSize, height - (chunk / chunkColumns) * chunkSize);
+	}
+
+	int ChunkComponents::getBorderComponent(int x, int y) const
+	{
+		int chunk = chunkOf(x, y);
+		int localX = x % chunkSize;
+		int localY = y % chunkSize;
+		int edge;
+		int position;
+		if (localY == 0 || localY == chunkHeight(chunk) - 1)
+		{
+			edge = localY == 0 ? TOP : BOTTOM;
+			position = localX;
+		}
+		else
+		{
+			edge = localX == 0 ? LEFT : RIGHT;
+			position = localY;
+		}
+
+		// Last run starting at or before the position
+		const std::vector<EdgeRun>& runs = chunks[chunk].edges[edge];
+		auto run = std::upper_bound(runs.begin(), runs.end(), position,
+			[](int value, const EdgeRun& run) { return value < run.start; }) - 1;
+		return run->component < 0 ? -1 : chunks[chunk].firstComponent + run->component;
+	}
+
+	int ChunkComponents::findComponent(int component)
+	{
+		while (componentParents[component] != component)
+		{
+			// Path halving keeps later lookups short
+			componentParents[component] = componentParents[componentParents[component]];
+			component = componentParents[component];
+		}
+		return component;
+	}
+
+	void ChunkComponents::mergeComponents(int first, int second)
+	{
+		first = findComponent(first);
+		second = findComponent(second);
+		if (first == second)
+		{
+			return;
+		}
+
+		if (componentRanks[first] < componentRanks[second])
+		{
+			std::swap(first, second);
+		}
+		componentParents[second] = first;
+		if (componentRanks[first] == componentRanks[second])
+		{
+			componentRanks[first]++;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "GridPager.h"
+
+namespace VulkanProject
+{
+	// Connected regions of a paged grid for Grid::areConnected, kept without a label per tile. Every chunk is flood
+	// filled on its own and only the regions reaching its border get an id, stored run-length encoded along its four
+	// edges; a union-find joins the ids of border tiles that touch across chunks. A query floods the chunks of its
+	// two tiles again, and the most recent few of those labellings are cached.
+	// The first query labels every chunk, paging the whole grid through once. An edit only marks its chunk, which is
+	// labelled again before the next query, and the union-find is rebuilt from the stored edges without paging.
+	// Not thread safe; Grid serialises the calls.
+	class ChunkComponents
+	{
+	public:
+		ChunkComponents();
+		~ChunkComponents();
+		void reset(GridPager* pager, int width, int height, int chunkSize);
+		// Whether a path of passable tiles joins two passable tiles
+		bool areConnected(int fromX, int fromY, int toX, int toY);
+		// The chunk holding (x, y) is labelled again before the next query
+		void markEdited(int x, int y);
+
+		static const int CACHED_LABELLINGS = 4;
+
+	private:
+		enum EDGE
+		{
+			TOP,
+			BOTTOM,
+			LEFT,
+			RIGHT,
+			EDGE_COUNT
+		};
+
+		// Tiles from 'start' up to the next run along one edge; 'component' numbers the chunk's border regions, -1 for barriers
+		struct EdgeRun
+		{
+			int start;
+			int component;
+		};
+
+		struct Chunk
+		{
+			// Top and bottom edges run along x, left and right ones along y
+			std::vector<EdgeRun> edges[EDGE_COUNT];
+			int firstComponent = 0;
+			int componentCount = 0;
+			bool edited = true;
+		};
+
+		// Flood fill of one chunk: a label per tile (-1 for barriers), and the union-find id of each label (-1 when
+		// that region never reaches the border)
+		struct Labelling
+		{
+			int chunk = -1;
+			uint64_t lastUse = 0;
+			std::vector<int> labels;
+			std::vector<int> components;
+		};
+
+		void refresh();
+		void buildChunk(int chunk);
+		int labelChunk(int chunk, std::vector<int>& labels);
+		const Labelling& getLabelling(int chunk);
+		int chunkOf(int x, int y) const;
+		int chunkWidth(int chunk) const;
+		int chunkHeight(int chunk) const;
+		// Union-find id of a tile on the edge of its chunk, -1 for a barrier
+		int getBorderComponent(int x, int y) const;
+		int findComponent(int component);
+		void mergeComponents(int first, int second);
+
+		GridPager* pager = nullptr;
+		int width = 0;
+		int height = 0;
+		int chunkSize = 0;
+		int chunkColumns = 0;
+		std::vector<Chunk> chunks;
+		// Set by an edit until the next query has relabelled the edited chunks
+		bool stale = true;
+		std::vector<int> componentParents;
+		std::vector<uint8_t> componentRanks;
+		Labelling labellings[CACHED_LABELLINGS];
+		uint64_t useCount = 0;
+		// Barrier bits of the chunk being flood filled, and its fill stack
+		std::vector<uint64_t> chunkBits;
+		std::vector<int> stack;
+	};
+}
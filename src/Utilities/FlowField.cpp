@@ -0,0 +1,168 @@
+#include "FlowField.h"
+#include "NodeTable.h"
+
+namespace VulkanProject
+{
+	FlowField::FlowField()
+	{
+	}
+
+	FlowField::~FlowField()
+	{
+	}
+
+	void FlowField::build(const int goal[2])
+	{
+		Grid::ensureLoaded();
+		goalX = goal[0];
+		goalY = goal[1];
+		width = Grid::getWidth();
+		height = Grid::getHeight();
+		gridVersion = Grid::getVersion();
+		expansionCount = 0;
+
+		// assign() keeps the capacity, so rebuilding on a grid of the same size allocates nothing
+		int nodeCount = width * height;
+		distances.assign(nodeCount, NodeTable::UNREACHED);
+		directions.assign(nodeCount, NO_DIRECTION);
+		openNodes.resize(nodeCount);
+
+		// Nothing can move into a barrier, so a goal on one is unreachable from everywhere
+		if (!Grid::inBounds(goalX, goalY) || Grid::isBarrier(goalX, goalY))
+		{
+			return;
+		}
+
+		int goalIndex = Grid::indexOf(goalX, goalY);
+		distances[goalIndex] = 0;
+		openNodes.push(goalIndex, 0);
+
+		while (!openNodes.empty())
+		{
+			int current = openNodes.pop();
+			expansionCount++;
+
+			int currentX = current % width;
+			int currentY = current / width;
+			for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+			{
+				int neighborX = currentX + Grid::DIRECTION_X[direction];
+				int neighborY = currentY + Grid::DIRECTION_Y[direction];
+				if (!Grid::inBounds(neighborX, neighborY))
+				{
+					continue;
+				}
+
+				// Orthogonal steps cost 1, diagonal steps cost sqrt(2)
+				int neighbor = Grid::indexOf(neighborX, neighborY);
+				double distance = distances[current] + (direction < 4 ? 1.0 : sqrt(2.0));
+				if (distance >= distances[neighbor])
+				{
+					continue;
+				}
+
+				// The neighbor's first move goes back the way the search came
+				directions[neighbor] = (int8_t)oppositeDirection(direction);
+
+				// An agent may leave a barrier it starts on, but no path passes through one, so it is never expanded
+				if (Grid::isBarrier(neighborX, neighborY))
+				{
+					distances[neighbor] = distance;
+				}
+				else if (distances[neighbor] == NodeTable::UNREACHED)
+				{
+					distances[neighbor] = distance;
+					openNodes.push(neighbor, distance);
+				}
+				else
+				{
+					distances[neighbor] = distance;
+					openNodes.decreaseKey(neighbor, distance);
+				}
+			}
+		}
+	}
+
+	int FlowField::getGoalX() const
+	{
+		return goalX;
+	}
+
+	int FlowField::getGoalY() const
+	{
+		return goalY;
+	}
+
+	uint64_t FlowField::getGridVersion() const
+	{
+		return gridVersion;
+	}
+
+	bool FlowField::isReachable(int x, int y) const
+	{
+		return getDistance(x, y) != NodeTable::UNREACHED;
+	}
+
+	double FlowField::getDistance(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= width || y >= height)
+		{
+			return NodeTable::UNREACHED;
+		}
+		return distances[(size_t)y * width + x];
+	}
+
+	int FlowField::getDirection(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= width || y >= height)
+		{
+			return NO_DIRECTION;
+		}
+		return directions[(size_t)y * width + x];
+	}
+
+	bool FlowField::getNextStep(int x, int y, int next[2]) const
+	{
+		int direction = getDirection(x, y);
+		if (direction == NO_DIRECTION)
+		{
+			return false;
+		}
+		next[0] = x + Grid::DIRECTION_X[direction];
+		next[1] = y + Grid::DIRECTION_Y[direction];
+		return true;
+	}
+
+	Path FlowField::generatePath(const int start[2]) const
+	{
+		int goal[2] = { goalX, goalY };
+		Path path = Path(start, goal);
+		if (!isReachable(start[0], start[1]))
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		std::vector<Tile> sequence = std::vector<Tile>();
+		int position[2] = { start[0], start[1] };
+		while (getNextStep(position[0], position[1], position))
+		{
+			sequence.push_back(Grid::at(position[0], position[1]));
+		}
+
+		LOG("Path Found.");
+		path.setSequence(std::move(sequence));
+		return path;
+	}
+
+	size_t FlowField::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	int FlowField::oppositeDirection(int direction)
+	{
+		// Orthogonal directions come first, each half listed so that +2 turns around
+		return direction < 4 ? (direction + 2) % 4 : 4 + (direction - 2) % 4;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "Path.h"
+
+namespace VulkanProject
+{
+	// Dijkstra map for one goal: a single reverse search from the goal stores, for every tile, the cost of the
+	// shortest path to the goal and the direction of the first move along it. Any number of agents heading for
+	// that goal can then read their next step in O(1). Reading is safe from several threads; building is not.
+	class FlowField
+	{
+	public:
+		FlowField();
+		~FlowField();
+		// Rebuilds the field over the current grid, reusing the buffers of earlier builds
+		void build(const int goal[2]);
+		int getGoalX() const;
+		int getGoalY() const;
+		// Grid version the field was built against
+		uint64_t getGridVersion() const;
+		bool isReachable(int x, int y) const;
+		// Cost of the shortest path to the goal, NodeTable::UNREACHED when there is none
+		double getDistance(int x, int y) const;
+		// Index into Grid::DIRECTION_X/Y of the first move towards the goal, or NO_DIRECTION at the goal and
+		// on tiles that cannot reach it
+		int getDirection(int x, int y) const;
+		bool getNextStep(int x, int y, int next[2]) const;
+		// Follows the directions from 'start' to the goal
+		Path generatePath(const int start[2]) const;
+		// Tiles settled by the most recent build
+		size_t getExpansionCount() const;
+
+		static constexpr int8_t NO_DIRECTION = -1;
+
+	private:
+		static int oppositeDirection(int direction);
+
+		int goalX = 0;
+		int goalY = 0;
+		int width = 0;
+		int height = 0;
+		uint64_t gridVersion = 0;
+		std::vector<double> distances;
+		std::vector<int8_t> directions;
+		IndexedHeap openNodes;
+		size_t expansionCount = 0;
+	};
+}
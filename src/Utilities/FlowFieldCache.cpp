@@ -0,0 +1,88 @@
+#include "FlowFieldCache.h"
+
+namespace VulkanProject
+{
+	FlowFieldCache::FlowFieldCache(size_t capacity)
+	{
+		this->capacity = std::max<size_t>(capacity, 1);
+	}
+
+	FlowFieldCache::~FlowFieldCache()
+	{
+	}
+
+	FlowFieldCache* FlowFieldCache::getInstance()
+	{
+		static FlowFieldCache instance = FlowFieldCache();
+		return &instance;
+	}
+
+	std::shared_ptr<const FlowField> FlowFieldCache::getField(const int goal[2])
+	{
+		// Building under the lock means agents asking for the same new goal wait for one build instead of each running their own
+		std::lock_guard<std::mutex> lock(mutex);
+		Grid::ensureLoaded();
+		useCounter++;
+
+		Slot* slot = nullptr;
+		for (Slot& candidate : slots)
+		{
+			if (candidate.goalX == goal[0] && candidate.goalY == goal[1])
+			{
+				slot = &candidate;
+				break;
+			}
+		}
+
+		if (slot != nullptr && slot->field->getGridVersion() == Grid::getVersion())
+		{
+			hitCount++;
+			slot->lastUse = useCounter;
+			return slot->field;
+		}
+
+		if (slot == nullptr)
+		{
+			if (slots.size() < capacity)
+			{
+				slots.push_back({ goal[0], goal[1], nullptr, 0 });
+				slot = &slots.back();
+			}
+			else
+			{
+				// Take over the least recently used goal's slot
+				slot = &*std::min_element(slots.begin(), slots.end(),
+					[](const Slot& first, const Slot& second) { return first.lastUse < second.lastUse; });
+				slot->goalX = goal[0];
+				slot->goalY = goal[1];
+			}
+		}
+
+		// The old field stays with whoever still reads it. Reusing its buffers when use_count() is 1 would race:
+		// that count is a relaxed load, so the last reader's reads need not have finished
+		std::shared_ptr<FlowField> field = std::make_shared<FlowField>();
+		field->build(goal);
+		slot->field = field;
+		slot->lastUse = useCounter;
+		buildCount++;
+		return slot->field;
+	}
+
+	void FlowFieldCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		slots.clear();
+	}
+
+	size_t FlowFieldCache::getHitCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return hitCount;
+	}
+
+	size_t FlowFieldCache::getBuildCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return buildCount;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "FlowField.h"
+#include <memory>
+#include <mutex>
+
+namespace VulkanProject
+{
+	// Keeps the flow fields of the most recently used goals. A field is handed out as long as the grid version
+	// it was built against is current; after an edit, or once its slot goes to another goal, a new field is built
+	// the next time its goal is asked for. Fields are never rebuilt in place: callers keep a shared_ptr and may
+	// still be reading the old one on another thread.
+	class FlowFieldCache
+	{
+	public:
+		FlowFieldCache(size_t capacity = DEFAULT_CAPACITY);
+		~FlowFieldCache();
+		// Shared cache used by SearchContext's FLOW_FIELD mode
+		static FlowFieldCache* getInstance();
+		std::shared_ptr<const FlowField> getField(const int goal[2]);
+		void clear();
+		size_t getHitCount() const;
+		size_t getBuildCount() const;
+
+		static const size_t DEFAULT_CAPACITY = 8;
+
+	private:
+		struct Slot
+		{
+			int goalX;
+			int goalY;
+			std::shared_ptr<FlowField> field;
+			uint64_t lastUse;
+		};
+
+		mutable std::mutex mutex;
+		std::vector<Slot> slots;
+		size_t capacity;
+		uint64_t useCounter = 0;
+		size_t hitCount = 0;
+		size_t buildCount = 0;
+	};
+}
@@ -2,7 +2,26 @@
 
 namespace VulkanProject
 {
+	int Grid::width = 0;
+	int Grid::height = 0;
+	uint64_t* Grid::barrierData = nullptr;
+	std::vector<uint64_t> Grid::barrierBits = std::vector<uint64_t>();
+	GridFile Grid::gridFile;
+	int Grid::rowWords = 0;
+	GridPager Grid::pager;
+	ChunkComponents Grid::chunkComponents;
+	bool Grid::paged = false;
+	size_t Grid::pageBudget = Grid::DEFAULT_PAGE_BUDGET;
 	std::vector<Tile> Grid::grid = std::vector<Tile>();
+	uint64_t Grid::gridVersion = ~uint64_t(0);
+	std::vector<int> Grid::editLog = std::vector<int>();
+	uint64_t Grid::editLogBaseVersion = 0;
+	uint64_t Grid::version = 0;
+	std::vector<int> Grid::componentIds = std::vector<int>();
+	std::vector<int> Grid::componentParents = std::vector<int>();
+	std::vector<uint8_t> Grid::componentRanks = std::vector<uint8_t>();
+	std::atomic<bool> Grid::componentsStale = true;
+	std::mutex Grid::componentMutex;
 
 	Grid::Grid()
 	{
@@ -12,30 +31,226 @@ namespace VulkanProject
 	{
 	}
 
-	std::vector<Tile>& Grid::getGrid()
+	void Grid::ensureLoaded()
 	{
-		if (grid.empty())
+		if (barrierData != nullptr || paged)
 		{
-			readBarrierFile();
+			return;
+		}
+
+		// A converted binary grid maps in without parsing anything, unless Barriers.txt was edited after converting
+		if (isGridFileCurrent() && loadGridFile("./Barriers.grid"))
+		{
+			return;
+		}
+		readBarrierFile();
+	}
+
+	bool Grid::isGridFileCurrent()
+	{
+		std::error_code error;
+		std::filesystem::file_time_type gridTime = std::filesystem::last_write_time("./Barriers.grid", error);
+		if (error)
+		{
+			return false;
+		}
+		std::filesystem::file_time_type textTime = std::filesystem::last_write_time("./Barriers.txt", error);
+		if (!error && textTime > gridTime)
+		{
+			LOG("Barriers.grid is older than Barriers.txt, parsing the text instead.");
+			return false;
+		}
+		return true;
+	}
+
+	const std::vector<Tile>& Grid::getGrid()
+	{
+		ensureLoaded();
+		if (gridVersion != version)
+		{
+			grid.resize((size_t)width * height);
+			for (int y = 0; y < height; y++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					grid[indexOf(x, y)] = at(x, y);
+				}
+			}
+			gridVersion = version;
 		}
 		return grid;
 	}
 
 	void Grid::setGrid(std::vector<Tile> grid)
 	{
-		Grid::grid = grid;
+		placeTiles(grid);
+	}
+
+	void Grid::setGrid(int width, int height, std::vector<uint64_t> bits)
+	{
+		if (width < 0 || height < 0 || bits.size() != (size_t)((width + 63) / 64) * height)
+		{
+			throw std::runtime_error("Barrier bits do not match the grid size!");
+		}
+		barrierBits = std::move(bits);
+		useOwnedBits(width, height);
 	}
 
 	Tile Grid::getTileAtPosition(int x, int y)
 	{
-		for (Tile tile : grid)
+		if (!inBounds(x, y))
 		{
-			if (tile.getX() == x && tile.getY() == y)
+			return Tile();
+		}
+		return at(x, y);
+	}
+
+	int Grid::getWidth()
+	{
+		return width;
+	}
+
+	int Grid::getHeight()
+	{
+		return height;
+	}
+
+	bool Grid::inBounds(int x, int y)
+	{
+		return x >= 0 && y >= 0 && x < width && y < height;
+	}
+
+	Tile Grid::at(int x, int y)
+	{
+		return Tile(x, y, isBarrier(x, y));
+	}
+
+	Tile Grid::at(int index)
+	{
+		return at(index % width, index / width);
+	}
+
+	bool Grid::isBarrier(int x, int y)
+	{
+		if (paged)
+		{
+			return pager.isBarrier(x, y);
+		}
+		return (barrierData[(size_t)y * rowWords + x / 64] >> (x % 64)) & 1;
+	}
+
+	int Grid::indexOf(int x, int y)
+	{
+		return y * width + x;
+	}
+
+	Grid::Neighbors Grid::neighbors(int x, int y)
+	{
+		return Neighbors(x, y);
+	}
+
+	void Grid::setBarrier(int x, int y, bool barrier)
+	{
+		bool wasBarrier = isBarrier(x, y);
+		if (paged)
+		{
+			pager.setBarrier(x, y, barrier);
+		}
+		else
+		{
+			uint64_t mask = uint64_t(1) << (x % 64);
+			uint64_t& word = barrierData[(size_t)y * rowWords + x / 64];
+			word = barrier ? (word | mask) : (word & ~mask);
+		}
+		if (barrier != wasBarrier && paged)
+		{
+			std::lock_guard<std::mutex> lock(componentMutex);
+			chunkComponents.markEdited(x, y);
+		}
+		else if (barrier != wasBarrier)
+		{
+			updateComponents(x, y, barrier);
+		}
+
+		// Keep an up to date tile copy current instead of rebuilding it on the next getGrid()
+		if (gridVersion == version)
+		{
+			grid[indexOf(x, y)].setBarrier(barrier);
+			gridVersion++;
+		}
+
+		// Keep the log bounded by forgetting the oldest half once it fills up
+		if (editLog.size() == MAX_EDIT_LOG)
+		{
+			editLog.erase(editLog.begin(), editLog.begin() + MAX_EDIT_LOG / 2);
+			editLogBaseVersion += MAX_EDIT_LOG / 2;
+		}
+		editLog.push_back(indexOf(x, y));
+		version++;
+	}
+
+	const uint64_t* Grid::getBarrierRow(int y)
+	{
+		return paged ? nullptr : &barrierData[(size_t)y * rowWords];
+	}
+
+	uint64_t Grid::getBarrierWord(int y, int word)
+	{
+		return paged ? pager.getWord(y, word) : barrierData[(size_t)y * rowWords + word];
+	}
+
+	int Grid::getRowWords()
+	{
+		return rowWords;
+	}
+
+	uint8_t Grid::getOpenNeighbors(int x, int y)
+	{
+		// Barrier bits of the 3x3 block around (x, y), three per row from left to right; off the grid counts as a barrier
+		uint32_t rows[3];
+		for (int row = 0; row < 3; row++)
+		{
+			int rowY = y + row - 1;
+			if (rowY < 0 || rowY >= height)
 			{
-				return tile;
+				rows[row] = 7;
+				continue;
 			}
+
+			if (paged)
+			{
+				uint32_t left = x > 0 ? pager.isBarrier(x - 1, rowY) : 1;
+				uint32_t right = x + 1 < width ? pager.isBarrier(x + 1, rowY) : 1;
+				rows[row] = left | (uint32_t)pager.isBarrier(x, rowY) << 1 | right << 2;
+				continue;
+			}
+
+			const uint64_t* bits = &barrierData[(size_t)rowY * rowWords];
+			uint32_t left = x > 0 ? (bits[(x - 1) / 64] >> ((x - 1) % 64)) & 1 : 1;
+			uint32_t middle = (bits[x / 64] >> (x % 64)) & 1;
+			uint32_t right = x + 1 < width ? (bits[(x + 1) / 64] >> ((x + 1) % 64)) & 1 : 1;
+			rows[row] = left | middle << 1 | right << 2;
+		}
+
+		// Scatter into the order of DIRECTION_X/Y: east, south, west, north, then the diagonals
+		uint32_t blocked = (rows[1] >> 2 & 1) | (rows[2] >> 1 & 1) << 1 | (rows[1] & 1) << 2 | (rows[0] >> 1 & 1) << 3 |
+			(rows[2] >> 2 & 1) << 4 | (rows[2] & 1) << 5 | (rows[0] & 1) << 6 | (rows[0] >> 2 & 1) << 7;
+		return (uint8_t)~blocked;
+	}
+
+	uint64_t Grid::getVersion()
+	{
+		return version;
+	}
+
+	bool Grid::getChangesSince(uint64_t version, std::vector<int>& changedTiles)
+	{
+		if (version < editLogBaseVersion || version > Grid::version)
+		{
+			return false;
 		}
-		return Tile();
+		changedTiles.insert(changedTiles.end(), editLog.begin() + (version - editLogBaseVersion), editLog.end());
+		return true;
 	}
 
 	void Grid::generateGrid()
@@ -43,35 +258,426 @@ namespace VulkanProject
 		readBarrierFile();
 	}
 
+	bool Grid::loadGridFile(const std::string& path)
+	{
+		// The pager reads from the mapping about to be replaced
+		bool wasMapped = gridFile.isOpen();
+		pager.detach();
+		paged = false;
+		bool opened = gridFile.open(path);
+		// Tiles are numbered with an int (see indexOf), paged grids included
+		if (opened && (int64_t)gridFile.getWidth() * gridFile.getHeight() > std::numeric_limits<int>::max())
+		{
+			std::cerr << "ERROR::Grid file has more tiles than a tile index can hold!" << std::endl;
+			gridFile.close();
+			opened = false;
+		}
+		if (!opened)
+		{
+			// Opening closed the old mapping, so a grid that lived in it is gone
+			if (wasMapped)
+			{
+				width = 0;
+				height = 0;
+				rowWords = 0;
+				barrierData = nullptr;
+				beginNewGrid();
+			}
+			return false;
+		}
+
+		width = gridFile.getWidth();
+		height = gridFile.getHeight();
+		rowWords = gridFile.getRowWords();
+		barrierData = gridFile.getBits();
+		barrierBits = std::vector<uint64_t>();
+		if (gridFile.getChunkSize() != 0)
+		{
+			pager.attach(gridFile, pageBudget);
+			chunkComponents.reset(&pager, width, height, gridFile.getChunkSize());
+			paged = true;
+			barrierData = nullptr;
+		}
+		beginNewGrid();
+		return true;
+	}
+
+	void Grid::setPageBudget(size_t bytes)
+	{
+		pageBudget = bytes;
+	}
+
+	bool Grid::isPaged()
+	{
+		return paged;
+	}
+
+	GridPager::Counters Grid::getPagingCounters()
+	{
+		return paged ? pager.getCounters() : GridPager::Counters{ 0, 0, 0, 0 };
+	}
+
+	bool Grid::saveGridFile(const std::string& path)
+	{
+		ensureLoaded();
+		// Edits to a paged grid live in its copy-on-write mapping, chunks included
+		if (paged)
+		{
+			return GridFile::write(path, width, height, gridFile.getBits(), gridFile.getChunkSize());
+		}
+		return GridFile::write(path, width, height, barrierData);
+	}
+
 	void Grid::readBarrierFile()
 	{
-		std::ifstream barrierFile("./Barriers.txt");
-		if (barrierFile.is_open())
+		int fileWidth = 0;
+		int fileHeight = 0;
+		if (GridFile::readText("./Barriers.txt", fileWidth, fileHeight, barrierBits))
+		{
+			useOwnedBits(fileWidth, fileHeight);
+		}
+	}
+
+	void Grid::placeTiles(std::vector<Tile>& tiles)
+	{
+		int tilesWidth = 0;
+		int tilesHeight = 0;
+		for (const Tile& tile : tiles)
+		{
+			tilesWidth = std::max(tilesWidth, tile.getX() + 1);
+			tilesHeight = std::max(tilesHeight, tile.getY() + 1);
+		}
+
+		// Any cell not covered by the input (ragged rows, missing tiles) is treated as a barrier
+		int tilesRowWords = (tilesWidth + 63) / 64;
+		barrierBits.assign((size_t)tilesRowWords * tilesHeight, 0);
+		for (int y = 0; y < tilesHeight; y++)
 		{
-			int row = 0;
-			std::string line;
-			while (std::getline(barrierFile, line))
+			for (int x = 0; x < tilesWidth; x++)
 			{
-				int col = 0;
-				for (unsigned int i = 0; i < line.length(); i++)
+				barrierBits[(size_t)y * tilesRowWords + x / 64] |= uint64_t(1) << (x % 64);
+			}
+		}
+
+		for (const Tile& tile : tiles)
+		{
+			if (tile.getX() >= 0 && tile.getY() >= 0 && !tile.isBarrier())
+			{
+				barrierBits[(size_t)tile.getY() * tilesRowWords + tile.getX() / 64] &= ~(uint64_t(1) << (tile.getX() % 64));
+			}
+		}
+
+		useOwnedBits(tilesWidth, tilesHeight);
+	}
+
+	void Grid::useOwnedBits(int width, int height)
+	{
+		Grid::width = width;
+		Grid::height = height;
+		rowWords = (width + 63) / 64;
+		barrierData = barrierBits.data();
+		pager.detach();
+		paged = false;
+		gridFile.close();
+		beginNewGrid();
+	}
+
+	void Grid::beginNewGrid()
+	{
+		// Earlier edits describe a grid that no longer exists
+		version++;
+		editLog.clear();
+		editLogBaseVersion = version;
+
+		// Labelled on first use, so mapping a large grid file stays instant
+		componentIds = std::vector<int>();
+		componentParents = std::vector<int>();
+		componentRanks = std::vector<uint8_t>();
+		componentsStale = true;
+	}
+
+	bool Grid::areConnected(int fromX, int fromY, int toX, int toY)
+	{
+		if (!inBounds(fromX, fromY) || !inBounds(toX, toY))
+		{
+			return false;
+		}
+		if (fromX == toX && fromY == toY)
+		{
+			return true;
+		}
+		// Nothing can move into a barrier
+		if (isBarrier(toX, toY))
+		{
+			return false;
+		}
+		// A paged grid keeps its labels per chunk, and answering may flood a chunk again, so there queries take turns
+		std::unique_lock<std::mutex> lock(componentMutex, std::defer_lock);
+		int target = -1;
+		if (paged)
+		{
+			lock.lock();
+		}
+		else
+		{
+			refreshComponents();
+			target = findComponent(getComponent(toX, toY));
+		}
+		auto reachesTarget = [&](int x, int y)
+		{
+			return paged ? chunkComponents.areConnected(x, y, toX, toY) : findComponent(getComponent(x, y)) == target;
+		};
+
+		if (!isBarrier(fromX, fromY))
+		{
+			return reachesTarget(fromX, fromY);
+		}
+
+		// A search may still leave a barrier it starts on, into any passable neighbor
+		for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+		{
+			int neighborX = fromX + DIRECTION_X[direction];
+			int neighborY = fromY + DIRECTION_Y[direction];
+			if (inBounds(neighborX, neighborY) && !isBarrier(neighborX, neighborY) && reachesTarget(neighborX, neighborY))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Grid::refreshComponents()
+	{
+		if (!componentsStale.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		// Several searching threads may get here at once after an edit; one of them relabels
+		std::lock_guard<std::mutex> lock(componentMutex);
+		if (componentsStale.load(std::memory_order_relaxed))
+		{
+			labelComponents();
+			componentsStale.store(false, std::memory_order_release);
+		}
+	}
+
+	void Grid::labelComponents()
+	{
+		componentIds.assign((size_t)width * height, -1);
+		componentParents.clear();
+		componentRanks.clear();
+
+		// Flood fill every passable region that has no label yet
+		std::vector<int> stack = std::vector<int>();
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				if (componentIds[indexOf(x, y)] != -1 || isBarrier(x, y))
 				{
-					char value = line.at(i);
-					if (value == ',' || value == ' ')
+					continue;
+				}
+
+				int component = (int)componentParents.size();
+				componentParents.push_back(component);
+				componentRanks.push_back(0);
+				componentIds[indexOf(x, y)] = component;
+				stack.push_back(indexOf(x, y));
+				while (!stack.empty())
+				{
+					int tile = stack.back();
+					stack.pop_back();
+					int tileX = tile % width;
+					int tileY = tile / width;
+					for (int direction = 0; direction < DIRECTION_COUNT; direction++)
 					{
-						continue;
+						int neighborX = tileX + DIRECTION_X[direction];
+						int neighborY = tileY + DIRECTION_Y[direction];
+						if (inBounds(neighborX, neighborY) && componentIds[indexOf(neighborX, neighborY)] == -1 &&
+							!isBarrier(neighborX, neighborY))
+						{
+							componentIds[indexOf(neighborX, neighborY)] = component;
+							stack.push_back(indexOf(neighborX, neighborY));
+						}
 					}
-					bool barrier = (value == '1');
-					Tile tile = Tile(col, row, barrier);
-					grid.push_back(tile);
-					col++;
 				}
-				row++;
 			}
-			barrierFile.close();
 		}
-		else
+	}
+
+	void Grid::updateComponents(int x, int y, bool barrier)
+	{
+		// A pending relabel will see this edit anyway
+		if (componentsStale.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		if (!barrier)
+		{
+			// The opened tile joins every region around it. Ids are never reused, so relabel once they pile up.
+			if (componentParents.size() >= componentIds.size() + 1024)
+			{
+				componentsStale = true;
+				return;
+			}
+			int component = (int)componentParents.size();
+			componentParents.push_back(component);
+			componentRanks.push_back(0);
+			componentIds[indexOf(x, y)] = component;
+			for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+			{
+				int neighborX = x + DIRECTION_X[direction];
+				int neighborY = y + DIRECTION_Y[direction];
+				if (inBounds(neighborX, neighborY) && !isBarrier(neighborX, neighborY))
+				{
+					mergeComponents(component, getComponent(neighborX, neighborY));
+				}
+			}
+			return;
+		}
+
+		componentIds[indexOf(x, y)] = -1;
+
+		// Any route through the new barrier entered and left it via two of its neighbors. If the passable
+		// neighbors all touch each other around it, every such route has a detour and nothing was split.
+		int neighborX[DIRECTION_COUNT];
+		int neighborY[DIRECTION_COUNT];
+		int groups[DIRECTION_COUNT];
+		int count = 0;
+		for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+		{
+			int candidateX = x + DIRECTION_X[direction];
+			int candidateY = y + DIRECTION_Y[direction];
+			if (inBounds(candidateX, candidateY) && !isBarrier(candidateX, candidateY))
+			{
+				neighborX[count] = candidateX;
+				neighborY[count] = candidateY;
+				groups[count] = count;
+				count++;
+			}
+		}
+
+		// Merge neighbors that touch until nothing changes; there are at most eight of them
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (int first = 0; first < count; first++)
+			{
+				for (int second = first + 1; second < count; second++)
+				{
+					if (groups[first] != groups[second] &&
+						abs(neighborX[first] - neighborX[second]) <= 1 && abs(neighborY[first] - neighborY[second]) <= 1)
+					{
+						int group = std::min(groups[first], groups[second]);
+						groups[first] = group;
+						groups[second] = group;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		for (int i = 1; i < count; i++)
+		{
+			if (groups[i] != groups[0])
+			{
+				componentsStale = true;
+				return;
+			}
+		}
+	}
+
+	int Grid::findComponent(int component)
+	{
+		while (componentParents[component] != component)
+		{
+			component = componentParents[component];
+		}
+		return component;
+	}
+
+	void Grid::mergeComponents(int first, int second)
+	{
+		first = findComponent(first);
+		second = findComponent(second);
+		if (first == second)
+		{
+			return;
+		}
+
+		if (componentRanks[first] < componentRanks[second])
+		{
+			std::swap(first, second);
+		}
+		componentParents[second] = first;
+		if (componentRanks[first] == componentRanks[second])
 		{
-			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			componentRanks[first]++;
+		}
+	}
+
+	int Grid::getComponent(int x, int y)
+	{
+		return componentIds[indexOf(x, y)];
+	}
+
+	Grid::Neighbors::Neighbors(int x, int y)
+	{
+		this->x = x;
+		this->y = y;
+	}
+
+	Grid::Neighbors::Iterator Grid::Neighbors::begin() const
+	{
+		return Iterator(x, y, 0);
+	}
+
+	Grid::Neighbors::Iterator Grid::Neighbors::end() const
+	{
+		return Iterator(x, y, DIRECTION_COUNT);
+	}
+
+	Grid::Neighbors::Iterator::Iterator(int x, int y, int direction)
+	{
+		this->x = x;
+		this->y = y;
+		this->direction = direction;
+
+		skipBlocked();
+	}
+
+	Tile Grid::Neighbors::Iterator::operator*() const
+	{
+		return Tile(x + DIRECTION_X[direction], y + DIRECTION_Y[direction], false);
+	}
+
+	Grid::Neighbors::Iterator& Grid::Neighbors::Iterator::operator++()
+	{
+		direction++;
+		skipBlocked();
+		return *this;
+	}
+
+	bool Grid::Neighbors::Iterator::operator!=(const Iterator& other) const
+	{
+		return direction != other.direction;
+	}
+
+	void Grid::Neighbors::Iterator::skipBlocked()
+	{
+		// Advance to the next direction that lands on an in-bounds, passable tile
+		while (direction < DIRECTION_COUNT)
+		{
+			int neighborX = x + DIRECTION_X[direction];
+			int neighborY = y + DIRECTION_Y[direction];
+			if (Grid::inBounds(neighborX, neighborY) && !Grid::isBarrier(neighborX, neighborY))
+			{
+				return;
+			}
+			direction++;
 		}
 	}
 }
@@ -1,23 +1,148 @@
 #pragma once
 #include "Tile.h"
+#include "GridFile.h"
+#include "ChunkComponents.h"
+#include "GridPager.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <fstream>
+#include <filesystem>
+#include <limits>
 
 namespace VulkanProject
 {
 	class Grid
 	{
 	public:
+		// Walks the (up to) eight passable, in-bounds tiles around a position without copying the grid
+		class Neighbors
+		{
+		public:
+			class Iterator
+			{
+			public:
+				Iterator(int x, int y, int direction);
+				Tile operator*() const;
+				Iterator& operator++();
+				bool operator!=(const Iterator& other) const;
+
+			private:
+				void skipBlocked();
+
+				int x;
+				int y;
+				int direction;
+			};
+
+			Neighbors(int x, int y);
+			Iterator begin() const;
+			Iterator end() const;
+
+		private:
+			int x;
+			int y;
+		};
+
 		Grid();
 		~Grid();
-		static std::vector<Tile>& getGrid();
+		// Loads ./Barriers.grid if it exists and is not older than ./Barriers.txt, otherwise parses ./Barriers.txt;
+		// does nothing once a grid is loaded
+		static void ensureLoaded();
+		// Tile copy of the barrier bits, rebuilt on demand; edits must go through setBarrier
+		static const std::vector<Tile>& getGrid();
 		static void setGrid(std::vector<Tile> grid);
+		// Takes barrier bits already laid out like getBarrierRow (see GridFile)
+		static void setGrid(int width, int height, std::vector<uint64_t> bits);
 		static void generateGrid();
+		// Maps a binary grid file (see GridFile) and uses its rows directly as the barrier bits. A tiled file is
+		// paged through GridPager instead, within the page budget, so it may be far larger than memory. Either
+		// way the grid may hold at most INT_MAX tiles, as tile indices are ints.
+		static bool loadGridFile(const std::string& path);
+		// Bytes of chunk copies a tiled grid may keep resident; applies from the next loadGridFile
+		static void setPageBudget(size_t bytes);
+		static bool isPaged();
+		// Page faults, chunk loads and evictions since the tiled grid was loaded; all zero for other grids
+		static GridPager::Counters getPagingCounters();
+		static bool saveGridFile(const std::string& path);
 		static Tile getTileAtPosition(int x, int y);
+		static int getWidth();
+		static int getHeight();
+		static bool inBounds(int x, int y);
+		static Tile at(int x, int y);
+		static Tile at(int index);
+		static bool isBarrier(int x, int y);
+		static int indexOf(int x, int y);
+		static Neighbors neighbors(int x, int y);
+		static void setBarrier(int x, int y, bool barrier);
+		// Barrier bits of row y, one bit per tile (bit x % 64 of word x / 64), padded to whole words.
+		// A paged grid has no rows in memory and returns nullptr; getBarrierWord works for every grid.
+		static const uint64_t* getBarrierRow(int y);
+		static uint64_t getBarrierWord(int y, int word);
+		static int getRowWords();
+		// Bit d is set when the move along DIRECTION_X/Y[d] from (x, y) stays on the grid and does not enter a barrier
+		static uint8_t getOpenNeighbors(int x, int y);
+		// Incremented by every edit; a new grid (setGrid or reloading the file) also bumps it
+		static uint64_t getVersion();
+		// Appends the grid indices edited since 'version'. Returns false when that history is no longer
+		// available (a new grid was loaded or the log was trimmed), in which case callers must rebuild fully.
+		static bool getChangesSince(uint64_t version, std::vector<int>& changedTiles);
+		// O(1) test whether any path can lead from one tile to the other. Labels of connected passable tiles are
+		// kept up to date on edits; only an added barrier that may split a region causes a relabel, on the next call.
+		// A paged grid has no room for a label per tile and uses ChunkComponents instead; its first call pages the
+		// whole grid through once, and later calls flood the one or two chunks involved.
+		static bool areConnected(int fromX, int fromY, int toX, int toY);
+
+		// Offsets of the eight surrounding tiles, orthogonal directions first
+		static constexpr int DIRECTION_COUNT = 8;
+		static constexpr int DIRECTION_X[DIRECTION_COUNT] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+		static constexpr int DIRECTION_Y[DIRECTION_COUNT] = { 0, 1, 0, -1, 1, 1, -1, -1 };
 
 	private:
+		// Whether ./Barriers.grid exists and is at least as new as ./Barriers.txt
+		static bool isGridFileCurrent();
 		static void readBarrierFile();
+		static void placeTiles(std::vector<Tile>& tiles);
+		static void useOwnedBits(int width, int height);
+		static void beginNewGrid();
+		static void refreshComponents();
+		static void labelComponents();
+		static void updateComponents(int x, int y, bool barrier);
+		static int findComponent(int component);
+		static void mergeComponents(int first, int second);
+		static int getComponent(int x, int y);
 
+		// Tiles are numbered row-major: the tile at (x, y) has index y * width + x
+		static int width;
+		static int height;
+		// The barrier flags, one bit per tile, are the grid itself. They point either into 'barrierBits'
+		// or into the mapped 'gridFile'.
+		static uint64_t* barrierData;
+		static std::vector<uint64_t> barrierBits;
+		static GridFile gridFile;
+		static int rowWords;
+		// Set while a tiled 'gridFile' is paged through 'pager'; 'barrierData' is null then
+		static GridPager pager;
+		static ChunkComponents chunkComponents;
+		static bool paged;
+		static size_t pageBudget;
+		static const size_t DEFAULT_PAGE_BUDGET = 64 << 20;
+		// Materialised on the first getGrid() call after a change
 		static std::vector<Tile> grid;
+		static uint64_t gridVersion;
+		// Tiles edited through setBarrier; entry i was made at version editLogBaseVersion + i + 1
+		static std::vector<int> editLog;
+		static uint64_t editLogBaseVersion;
+		static uint64_t version;
+		static const size_t MAX_EDIT_LOG = 1 << 16;
+		// Union-find over component ids: tiles keep the id they were labelled with (-1 for barriers) and
+		// merging regions only links their ids. Union by rank keeps lookups short without path compression,
+		// so concurrent searches can read the forest safely.
+		static std::vector<int> componentIds;
+		static std::vector<int> componentParents;
+		static std::vector<uint8_t> componentRanks;
+		static std::atomic<bool> componentsStale;
+		static std::mutex componentMutex;
 	};
 }
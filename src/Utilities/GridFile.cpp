@@ -0,0 +1,584 @@
+#include "GridFile.h"
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+#ifdef GRID_FILE_SSE2
+#include <emmintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanProject
+{
+	double GridFile::parseThroughput = 0;
+
+	GridFile::GridFile()
+	{
+	}
+
+	GridFile::~GridFile()
+	{
+		close();
+	}
+
+	bool GridFile::open(const std::string& path)
+	{
+		close();
+		if (!mapFile(path))
+		{
+			std::cerr << "ERROR::Unable to map grid file!" << std::endl;
+			return false;
+		}
+
+		Header header;
+		if (viewSize < sizeof(Header))
+		{
+			std::cerr << "ERROR::Grid file is truncated!" << std::endl;
+			close();
+			return false;
+		}
+		memcpy(&header, view, sizeof(Header));
+
+		bool tiled = header.formatVersion == TILED_FORMAT_VERSION;
+		if (memcmp(header.magic, "GRID", 4) != 0 || (header.formatVersion != FORMAT_VERSION && !tiled))
+		{
+			std::cerr << "ERROR::Unsupported grid file!" << std::endl;
+			close();
+			return false;
+		}
+
+		// Everything past here casts the sizes to int
+		if (header.width == 0 || header.height == 0 || header.width > (uint64_t)std::numeric_limits<int>::max() ||
+			header.height > (uint64_t)std::numeric_limits<int>::max())
+		{
+			std::cerr << "ERROR::Grid file is corrupt!" << std::endl;
+			close();
+			return false;
+		}
+
+		// The rows or chunks have to fit inside the file and line up on 64-bit words
+		uint64_t dataSize = (uint64_t)header.rowWords * header.height * sizeof(uint64_t);
+		if (tiled)
+		{
+			uint64_t chunkColumns = isValidChunkSize((int)header.chunkSize) ? (header.width + header.chunkSize - 1) / header.chunkSize : 0;
+			uint64_t chunkRows = isValidChunkSize((int)header.chunkSize) ? (header.height + header.chunkSize - 1) / header.chunkSize : 0;
+			dataSize = chunkColumns * chunkRows * header.chunkSize * (header.chunkSize / 64) * sizeof(uint64_t);
+		}
+		if (header.rowWords != (header.width + 63) / 64 || header.dataOffset % sizeof(uint64_t) != 0 ||
+			(tiled && !isValidChunkSize((int)header.chunkSize)) ||
+			header.dataOffset < sizeof(Header) || header.dataOffset > viewSize || dataSize > viewSize - header.dataOffset)
+		{
+			std::cerr << "ERROR::Grid file is corrupt!" << std::endl;
+			close();
+			return false;
+		}
+
+		width = (int)header.width;
+		height = (int)header.height;
+		rowWords = (int)header.rowWords;
+		chunkSize = tiled ? (int)header.chunkSize : 0;
+		bits = (uint64_t*)((char*)view + header.dataOffset);
+		return true;
+	}
+
+	void GridFile::close()
+	{
+		unmapFile();
+		width = 0;
+		height = 0;
+		rowWords = 0;
+		chunkSize = 0;
+		bits = nullptr;
+	}
+
+	bool GridFile::isOpen() const
+	{
+		return view != nullptr;
+	}
+
+	int GridFile::getWidth() const
+	{
+		return width;
+	}
+
+	int GridFile::getHeight() const
+	{
+		return height;
+	}
+
+	int GridFile::getRowWords() const
+	{
+		return rowWords;
+	}
+
+	int GridFile::getChunkSize() const
+	{
+		return chunkSize;
+	}
+
+	uint64_t* GridFile::getBits() const
+	{
+		return bits;
+	}
+
+	bool GridFile::readText(const std::string& path, int& width, int& height, std::vector<uint64_t>& bits)
+	{
+		std::chrono::steady_clock::time_point parseStart = std::chrono::steady_clock::now();
+
+		// One bulk read; lines are then located and parsed in place
+		std::ifstream textFile(path, std::ios::binary | std::ios::ate);
+		if (!textFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+		size_t size = (size_t)textFile.tellg();
+		std::vector<char> text = std::vector<char>(size);
+		textFile.seekg(0);
+		textFile.read(text.data(), (std::streamsize)size);
+		textFile.close();
+
+		// Split the text into one chunk per thread, each starting right after a newline
+		unsigned int threadCount = (unsigned int)std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), size / PARALLEL_CHUNK + 1);
+		std::vector<size_t> chunkStarts = std::vector<size_t>(threadCount + 1, size);
+		chunkStarts[0] = 0;
+		for (unsigned int chunk = 1; chunk < threadCount; chunk++)
+		{
+			// Several threads only run for non-empty files, so 'nominal' is at least 1
+			size_t nominal = std::max(size * chunk / threadCount, chunkStarts[chunk - 1]);
+			const char* newline = (const char*)memchr(text.data() + nominal - 1, '\n', size - nominal + 1);
+			chunkStarts[chunk] = newline != nullptr ? (size_t)(newline - text.data()) + 1 : size;
+		}
+
+		// First pass: every chunk finds its rows and counts their tiles
+		std::vector<std::vector<TextRow>> chunkRows = std::vector<std::vector<TextRow>>(threadCount);
+		runChunks(threadCount, [&](unsigned int chunk)
+		{
+			findRows(text.data() + chunkStarts[chunk], text.data() + chunkStarts[chunk + 1], chunkRows[chunk]);
+		});
+
+		// Rows may be ragged, so the width is only known once every row has been counted
+		std::vector<int> chunkFirstRows = std::vector<int>(threadCount);
+		width = 0;
+		height = 0;
+		for (unsigned int chunk = 0; chunk < threadCount; chunk++)
+		{
+			chunkFirstRows[chunk] = height;
+			height += (int)chunkRows[chunk].size();
+			for (const TextRow& row : chunkRows[chunk])
+			{
+				width = std::max(width, row.length);
+			}
+		}
+
+		// Second pass: the bits are allocated once and every chunk fills in its own rows
+		int rowWords = (width + 63) / 64;
+		bits.assign((size_t)rowWords * height, 0);
+		runChunks(threadCount, [&](unsigned int chunk)
+		{
+			for (size_t i = 0; i < chunkRows[chunk].size(); i++)
+			{
+				const TextRow& row = chunkRows[chunk][i];
+				packRow(row.begin, row.end, width, &bits[(size_t)(chunkFirstRows[chunk] + i) * rowWords]);
+			}
+		});
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parseStart).count();
+		parseThroughput = seconds > 0 ? (double)size / (1024.0 * 1024.0) / seconds : 0;
+		LOG("Parsed " << path << " (" << width << "x" << height << ") at " << parseThroughput << " MB/s");
+		return true;
+	}
+
+	bool GridFile::readMovingAiMap(const std::string& path, int& width, int& height, std::vector<uint64_t>& bits)
+	{
+		std::ifstream mapFile(path);
+		if (!mapFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+
+		// Header lines are "key value" pairs ending with a line that just says "map"
+		width = 0;
+		height = 0;
+		std::string key;
+		while (mapFile >> key && key != "map")
+		{
+			if (key == "height")
+			{
+				mapFile >> height;
+			}
+			else if (key == "width")
+			{
+				mapFile >> width;
+			}
+			else
+			{
+				mapFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			}
+		}
+		if (key != "map" || width <= 0 || height <= 0)
+		{
+			std::cerr << "ERROR::Unsupported map file!" << std::endl;
+			return false;
+		}
+		mapFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+		// Missing rows or characters are treated as barriers, like ragged rows of the text format
+		int rowWords = (width + 63) / 64;
+		bits.assign((size_t)rowWords * height, 0);
+		std::string line;
+		for (int y = 0; y < height; y++)
+		{
+			if (!std::getline(mapFile, line))
+			{
+				line.clear();
+			}
+
+			uint64_t* row = &bits[(size_t)y * rowWords];
+			for (int x = 0; x < width; x++)
+			{
+				char terrain = x < (int)line.size() ? line[x] : '@';
+				if (terrain != '.' && terrain != 'G' && terrain != 'S')
+				{
+					row[x / 64] |= uint64_t(1) << (x % 64);
+				}
+			}
+		}
+		return true;
+	}
+
+	double GridFile::getParseThroughput()
+	{
+		return parseThroughput;
+	}
+
+	bool GridFile::write(const std::string& path, int width, int height, const uint64_t* bits, int chunkSize)
+	{
+		if (chunkSize != 0 && !isValidChunkSize(chunkSize))
+		{
+			std::cerr << "ERROR::Chunk size must be a power of two from 64 to " << MAX_CHUNK_SIZE << "!" << std::endl;
+			return false;
+		}
+
+		std::ofstream gridFile(path, std::ios::binary | std::ios::trunc);
+		if (!gridFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+
+		Header header = Header();
+		memcpy(header.magic, "GRID", 4);
+		header.formatVersion = chunkSize != 0 ? TILED_FORMAT_VERSION : FORMAT_VERSION;
+		header.width = (uint32_t)width;
+		header.height = (uint32_t)height;
+		header.rowWords = (uint32_t)((width + 63) / 64);
+		header.chunkSize = (uint32_t)chunkSize;
+		header.dataOffset = sizeof(Header);
+
+		size_t wordCount = (size_t)header.rowWords * height;
+		if (chunkSize != 0)
+		{
+			wordCount = (size_t)((width + chunkSize - 1) / chunkSize) * ((height + chunkSize - 1) / chunkSize) * chunkSize * (chunkSize / 64);
+		}
+		gridFile.write((const char*)&header, sizeof(Header));
+		gridFile.write((const char*)bits, (std::streamsize)(wordCount * sizeof(uint64_t)));
+		gridFile.close();
+		if (!gridFile)
+		{
+			std::cerr << "ERROR::Unable to write grid file!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool GridFile::writeTiled(const std::string& path, int width, int height, const uint64_t* bits, int chunkSize)
+	{
+		if (!isValidChunkSize(chunkSize))
+		{
+			std::cerr << "ERROR::Chunk size must be a power of two from 64 to " << MAX_CHUNK_SIZE << "!" << std::endl;
+			return false;
+		}
+
+		std::ofstream gridFile(path, std::ios::binary | std::ios::trunc);
+		if (!gridFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+
+		Header header = Header();
+		memcpy(header.magic, "GRID", 4);
+		header.formatVersion = TILED_FORMAT_VERSION;
+		header.width = (uint32_t)width;
+		header.height = (uint32_t)height;
+		header.rowWords = (uint32_t)((width + 63) / 64);
+		header.chunkSize = (uint32_t)chunkSize;
+		header.dataOffset = sizeof(Header);
+		gridFile.write((const char*)&header, sizeof(Header));
+
+		// Only one row of chunks is held at a time, so grids far larger than memory can be tiled from a mapped file
+		int chunkWords = chunkSize / 64;
+		int chunkColumns = (width + chunkSize - 1) / chunkSize;
+		int chunkRows = (height + chunkSize - 1) / chunkSize;
+		std::vector<uint64_t> chunkRow = std::vector<uint64_t>((size_t)chunkColumns * chunkSize * chunkWords);
+		for (int chunkY = 0; chunkY < chunkRows; chunkY++)
+		{
+			std::fill(chunkRow.begin(), chunkRow.end(), ~uint64_t(0));
+			for (int row = 0; row < chunkSize && chunkY * chunkSize + row < height; row++)
+			{
+				const uint64_t* source = &bits[(size_t)(chunkY * chunkSize + row) * header.rowWords];
+				for (int word = 0; word < (int)header.rowWords; word++)
+				{
+					// Bits past the last column stay barriers
+					int tailBits = width - word * 64;
+					uint64_t value = tailBits >= 64 ? source[word] : source[word] | (~uint64_t(0) << tailBits);
+					chunkRow[((size_t)(word / chunkWords) * chunkSize + row) * chunkWords + word % chunkWords] = value;
+				}
+			}
+			gridFile.write((const char*)chunkRow.data(), (std::streamsize)(chunkRow.size() * sizeof(uint64_t)));
+		}
+
+		gridFile.close();
+		if (!gridFile)
+		{
+			std::cerr << "ERROR::Unable to write grid file!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool GridFile::convert(const std::string& sourcePath, const std::string& gridPath, int chunkSize)
+	{
+		// A grid file stored by rows is tiled straight from its mapping
+		GridFile source;
+		std::ifstream sourceFile(sourcePath, std::ios::binary);
+		char magic[4] = {};
+		if (sourceFile.read(magic, 4) && memcmp(magic, "GRID", 4) == 0)
+		{
+			sourceFile.close();
+			if (!source.open(sourcePath) || source.getChunkSize() != 0)
+			{
+				std::cerr << "ERROR::Only grid files stored by rows can be converted!" << std::endl;
+				return false;
+			}
+			return chunkSize != 0 ? writeTiled(gridPath, source.getWidth(), source.getHeight(), source.getBits(), chunkSize) :
+				write(gridPath, source.getWidth(), source.getHeight(), source.getBits());
+		}
+		sourceFile.close();
+
+		int width = 0;
+		int height = 0;
+		std::vector<uint64_t> bits = std::vector<uint64_t>();
+		if (!readText(sourcePath, width, height, bits))
+		{
+			return false;
+		}
+		return chunkSize != 0 ? writeTiled(gridPath, width, height, bits.data(), chunkSize) : write(gridPath, width, height, bits.data());
+	}
+
+	bool GridFile::isValidChunkSize(int chunkSize)
+	{
+		return chunkSize >= 64 && chunkSize <= MAX_CHUNK_SIZE && (chunkSize & (chunkSize - 1)) == 0;
+	}
+
+	void GridFile::runChunks(unsigned int chunkCount, const std::function<void(unsigned int)>& parseChunk)
+	{
+		std::vector<std::thread> workers = std::vector<std::thread>();
+		for (unsigned int chunk = 1; chunk < chunkCount; chunk++)
+		{
+			workers.emplace_back(parseChunk, chunk);
+		}
+		parseChunk(0);
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	void GridFile::findRows(const char* begin, const char* end, std::vector<TextRow>& rows)
+	{
+		while (begin < end)
+		{
+			const char* newline = (const char*)memchr(begin, '\n', end - begin);
+			const char* lineEnd = newline != nullptr ? newline : end;
+
+			// Blank lines (such as a trailing newline) don't count as rows
+			int length = countTiles(begin, lineEnd);
+			if (length > 0)
+			{
+				rows.push_back({ begin, lineEnd, length });
+			}
+			begin = lineEnd + 1;
+		}
+	}
+
+	int GridFile::countTiles(const char* begin, const char* end)
+	{
+		int count = 0;
+#ifdef GRID_FILE_SSE2
+		for (; end - begin >= 16; begin += 16)
+		{
+			uint32_t barriers;
+			count += std::popcount(classifyBlock(begin, barriers));
+		}
+#endif
+		for (; begin < end; begin++)
+		{
+			count += !isSeparator(*begin);
+		}
+		return count;
+	}
+
+	void GridFile::packRow(const char* begin, const char* end, int width, uint64_t* row)
+	{
+		int x = 0;
+#ifdef GRID_FILE_SSE2
+		for (; end - begin >= 16; begin += 16)
+		{
+			uint32_t barriers;
+			uint32_t tiles = classifyBlock(begin, barriers);
+
+			// A barrier's column is the number of tiles before it in the block
+			while (barriers != 0)
+			{
+				int bit = std::countr_zero(barriers);
+				int column = x + std::popcount(tiles & ((1u << bit) - 1));
+				row[column / 64] |= uint64_t(1) << (column % 64);
+				barriers &= barriers - 1;
+			}
+			x += std::popcount(tiles);
+		}
+#endif
+		for (; begin < end; begin++)
+		{
+			if (isSeparator(*begin))
+			{
+				continue;
+			}
+			if (*begin == '1')
+			{
+				row[x / 64] |= uint64_t(1) << (x % 64);
+			}
+			x++;
+		}
+
+		// Cells missing from a short row are barriers
+		for (; x < width; x++)
+		{
+			row[x / 64] |= uint64_t(1) << (x % 64);
+		}
+	}
+
+	bool GridFile::isSeparator(char value)
+	{
+		return value == ',' || value == ' ' || value == '\r';
+	}
+
+#ifdef GRID_FILE_SSE2
+	uint32_t GridFile::classifyBlock(const char* text, uint32_t& barriers)
+	{
+		// Sixteen characters at once: bit i of the result is set when text[i] is a tile, of 'barriers' when it is a '1'
+		__m128i block = _mm_loadu_si128((const __m128i*)text);
+		__m128i separators = _mm_or_si128(_mm_or_si128(
+			_mm_cmpeq_epi8(block, _mm_set1_epi8(',')),
+			_mm_cmpeq_epi8(block, _mm_set1_epi8(' '))),
+			_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')));
+		barriers = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('1')));
+		return ~(uint32_t)_mm_movemask_epi8(separators) & 0xFFFF;
+	}
+#endif
+
+	bool GridFile::mapFile(const std::string& path)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// PAGE_WRITECOPY / FILE_MAP_COPY give private pages on first write, leaving the file untouched
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		if (address == NULL)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		fileHandle = file;
+		mappingHandle = mapping;
+		view = address;
+		viewSize = (size_t)size.QuadPart;
+		return true;
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		// MAP_PRIVATE gives private pages on first write, leaving the file untouched
+		void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (address == MAP_FAILED)
+		{
+			return false;
+		}
+
+		view = address;
+		viewSize = (size_t)status.st_size;
+		return true;
+#endif
+	}
+
+	void GridFile::unmapFile()
+	{
+		if (view == nullptr)
+		{
+			return;
+		}
+
+#ifdef _WIN32
+		UnmapViewOfFile(view);
+		CloseHandle((HANDLE)mappingHandle);
+		CloseHandle((HANDLE)fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		munmap(view, viewSize);
+#endif
+		view = nullptr;
+		viewSize = 0;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "../Core/stdafx.h"
+#include <functional>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRID_FILE_SSE2
+#endif
+
+namespace VulkanProject
+{
+	// Binary grid format: a fixed 32 byte header followed by the barrier bits, row by row, in exactly the layout
+	// Grid keeps in memory (bit x % 64 of word x / 64, rows padded to whole 64-bit words, little-endian).
+	// Opening a file maps it copy-on-write, so the mapped rows can back the grid directly and edits never reach the disk.
+	// The tiled variant (TILED_FORMAT_VERSION) stores square chunks instead of rows: chunk after chunk in row-major
+	// order, each holding its own rows of chunkSize / 64 words, with tiles past the grid's edges set as barriers.
+	// A chunk is then one contiguous run of the file, which is what GridPager pages in.
+	class GridFile
+	{
+	public:
+		GridFile();
+		~GridFile();
+		GridFile(const GridFile&) = delete;
+		GridFile& operator=(const GridFile&) = delete;
+
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const;
+		int getWidth() const;
+		int getHeight() const;
+		int getRowWords() const;
+		// Side of the square chunks of a tiled file, 0 for a file stored by rows
+		int getChunkSize() const;
+		// Start of the mapped rows (or chunks); writable, but only this process sees the changes
+		uint64_t* getBits() const;
+
+		// Parses the text format (one row per line, '1' for a barrier, separated by commas or spaces) into bit rows.
+		// Rows shorter than the longest one are padded with barriers. Large files are parsed on several threads.
+		static bool readText(const std::string& path, int& width, int& height, std::vector<uint64_t>& bits);
+		// Parses a Moving AI benchmark map ("type octile", "height", "width", "map", then one character per tile).
+		// '.', 'G' and 'S' are passable; every other terrain is a barrier.
+		static bool readMovingAiMap(const std::string& path, int& width, int& height, std::vector<uint64_t>& bits);
+		// MB/s achieved by the most recent readText
+		static double getParseThroughput();
+		// 'bits' are rows, or chunks when 'chunkSize' is not 0
+		static bool write(const std::string& path, int width, int height, const uint64_t* bits, int chunkSize = 0);
+		// Writes rows laid out like getBarrierRow as a tiled file, one row of chunks at a time
+		static bool writeTiled(const std::string& path, int width, int height, const uint64_t* bits, int chunkSize);
+		// Reads the text format, or a grid file stored by rows, and writes it tiled when 'chunkSize' is not 0
+		static bool convert(const std::string& sourcePath, const std::string& gridPath, int chunkSize = 0);
+		static bool isValidChunkSize(int chunkSize);
+
+		static const uint32_t FORMAT_VERSION = 1;
+		static const uint32_t TILED_FORMAT_VERSION = 2;
+		static const int DEFAULT_CHUNK_SIZE = 256;
+		static const int MAX_CHUNK_SIZE = 4096;
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t formatVersion;
+			uint32_t width;
+			uint32_t height;
+			uint32_t rowWords;
+			// 0 in files stored by rows
+			uint32_t chunkSize;
+			uint64_t dataOffset;
+		};
+
+		// A non-blank line of the text format
+		struct TextRow
+		{
+			const char* begin;
+			const char* end;
+			int length;
+		};
+
+		// Files smaller than this are parsed on the calling thread alone
+		static const size_t PARALLEL_CHUNK = 1 << 20;
+
+		static void runChunks(unsigned int chunkCount, const std::function<void(unsigned int)>& parseChunk);
+		static void findRows(const char* begin, const char* end, std::vector<TextRow>& rows);
+		static int countTiles(const char* begin, const char* end);
+		static void packRow(const char* begin, const char* end, int width, uint64_t* row);
+		static bool isSeparator(char value);
+#ifdef GRID_FILE_SSE2
+		static uint32_t classifyBlock(const char* text, uint32_t& barriers);
+#endif
+
+		static double parseThroughput;
+
+		bool mapFile(const std::string& path);
+		void unmapFile();
+
+		void* view = nullptr;
+		size_t viewSize = 0;
+		// Native file and mapping handles, only used on Windows
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+		int width = 0;
+		int height = 0;
+		int rowWords = 0;
+		int chunkSize = 0;
+		uint64_t* bits = nullptr;
+	};
+}
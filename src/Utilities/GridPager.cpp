@@ -0,0 +1,211 @@
+#include "GridPager.h"
+#include <bit>
+
+namespace VulkanProject
+{
+	GridPager::GridPager()
+	{
+		resetCounters();
+	}
+
+	GridPager::~GridPager()
+	{
+	}
+
+	void GridPager::attach(const GridFile& file, size_t memoryBudget)
+	{
+		detach();
+		if (!file.isOpen() || file.getChunkSize() == 0)
+		{
+			throw std::runtime_error("Only tiled grid files can be paged!");
+		}
+
+		fileBits = file.getBits();
+		width = file.getWidth();
+		height = file.getHeight();
+		chunkSize = file.getChunkSize();
+		chunkShift = std::countr_zero((uint32_t)chunkSize);
+		chunkColumns = (width + chunkSize - 1) / chunkSize;
+		chunkRowWords = chunkSize / 64;
+		chunkWords = chunkSize * chunkRowWords;
+
+		size_t chunkCount = (size_t)chunkColumns * ((height + chunkSize - 1) / chunkSize);
+		slotCount = std::min(chunkCount, std::max(MIN_SLOTS, memoryBudget / (chunkWords * sizeof(uint64_t))));
+		slotBits = std::vector<uint64_t>(slotCount * chunkWords);
+		slotChunks = std::vector<std::atomic<int>>(slotCount);
+		slotReferenced = std::vector<std::atomic<uint8_t>>(slotCount);
+		slotSequences = std::vector<std::atomic<uint32_t>>(slotCount);
+		chunkSlots = std::vector<std::atomic<int>>(chunkCount);
+		for (std::atomic<int>& chunk : slotChunks)
+		{
+			chunk = -1;
+		}
+		for (std::atomic<int>& slot : chunkSlots)
+		{
+			slot = -1;
+		}
+		clockHand = 0;
+		resetCounters();
+	}
+
+	void GridPager::detach()
+	{
+		fileBits = nullptr;
+		width = 0;
+		height = 0;
+		chunkSize = 0;
+		slotCount = 0;
+		slotBits = std::vector<uint64_t>();
+		slotChunks = std::vector<std::atomic<int>>();
+		slotReferenced = std::vector<std::atomic<uint8_t>>();
+		slotSequences = std::vector<std::atomic<uint32_t>>();
+		chunkSlots = std::vector<std::atomic<int>>();
+	}
+
+	bool GridPager::isAttached() const
+	{
+		return fileBits != nullptr;
+	}
+
+	int GridPager::getChunkSize() const
+	{
+		return chunkSize;
+	}
+
+	bool GridPager::isBarrier(int x, int y)
+	{
+		int chunk = (y >> chunkShift) * chunkColumns + (x >> chunkShift);
+		int offset = (y & (chunkSize - 1)) * chunkRowWords + ((x & (chunkSize - 1)) >> 6);
+		return (readWord(chunk, offset) >> (x % 64)) & 1;
+	}
+
+	uint64_t GridPager::getWord(int y, int word)
+	{
+		int chunk = (y >> chunkShift) * chunkColumns + ((word * 64) >> chunkShift);
+		int offset = (y & (chunkSize - 1)) * chunkRowWords + (word & (chunkRowWords - 1));
+		return readWord(chunk, offset);
+	}
+
+	void GridPager::setBarrier(int x, int y, bool barrier)
+	{
+		int chunk = (y >> chunkShift) * chunkColumns + (x >> chunkShift);
+		int offset = (y & (chunkSize - 1)) * chunkRowWords + ((x & (chunkSize - 1)) >> 6);
+		uint64_t mask = uint64_t(1) << (x % 64);
+
+		// Holding the lock keeps the chunk from being loaded or evicted halfway through
+		std::lock_guard<std::mutex> lock(loadMutex);
+		uint64_t& fileWord = fileBits[(size_t)chunk * chunkWords + offset];
+		fileWord = barrier ? (fileWord | mask) : (fileWord & ~mask);
+		int slot = chunkSlots[chunk].load(std::memory_order_relaxed);
+		if (slot >= 0)
+		{
+			std::atomic_ref<uint64_t>(slotBits[(size_t)slot * chunkWords + offset]).store(fileWord, std::memory_order_relaxed);
+		}
+	}
+
+	GridPager::Counters GridPager::getCounters() const
+	{
+		return Counters{ pageFaults.load(std::memory_order_relaxed), chunkLoads.load(std::memory_order_relaxed),
+			evictions.load(std::memory_order_relaxed), residentChunks.load(std::memory_order_relaxed) };
+	}
+
+	void GridPager::resetCounters()
+	{
+		pageFaults = 0;
+		chunkLoads = 0;
+		evictions = 0;
+		residentChunks = 0;
+	}
+
+	uint64_t GridPager::readWord(int chunk, int offset)
+	{
+		while (true)
+		{
+			int slot = chunkSlots[chunk].load(std::memory_order_acquire);
+			if (slot < 0)
+			{
+				pageFaults.fetch_add(1, std::memory_order_relaxed);
+				slot = loadChunk(chunk);
+			}
+
+			// Seqlock read: an odd sequence means the slot is being refilled, and a sequence that moved while reading
+			// means 'value' may mix two chunks. Either way, try again.
+			uint32_t sequence = slotSequences[slot].load(std::memory_order_acquire);
+			if (sequence & 1)
+			{
+				continue;
+			}
+			bool holdsChunk = slotChunks[slot].load(std::memory_order_relaxed) == chunk;
+			uint64_t value = std::atomic_ref<uint64_t>(slotBits[(size_t)slot * chunkWords + offset]).load(std::memory_order_relaxed);
+
+			// The fence orders the reads above before the second look at the sequence
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (holdsChunk && slotSequences[slot].load(std::memory_order_relaxed) == sequence)
+			{
+				if (slotReferenced[slot].load(std::memory_order_relaxed) == 0)
+				{
+					slotReferenced[slot].store(1, std::memory_order_relaxed);
+				}
+				return value;
+			}
+		}
+	}
+
+	int GridPager::loadChunk(int chunk)
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+
+		// Another thread may have loaded it while this one waited
+		int slot = chunkSlots[chunk].load(std::memory_order_relaxed);
+		if (slot >= 0)
+		{
+			return slot;
+		}
+
+		slot = findVictim();
+		int evicted = slotChunks[slot].load(std::memory_order_relaxed);
+		if (evicted >= 0)
+		{
+			chunkSlots[evicted].store(-1, std::memory_order_relaxed);
+			evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			residentChunks.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Readers still inside the old chunk see the sequence go odd, or move on, and retry. The fence keeps the
+		// copy below from being seen before the odd sequence.
+		uint32_t sequence = slotSequences[slot].load(std::memory_order_relaxed);
+		slotSequences[slot].store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slotChunks[slot].store(chunk, std::memory_order_relaxed);
+		const uint64_t* source = &fileBits[(size_t)chunk * chunkWords];
+		uint64_t* destination = &slotBits[(size_t)slot * chunkWords];
+		for (int word = 0; word < chunkWords; word++)
+		{
+			std::atomic_ref<uint64_t>(destination[word]).store(source[word], std::memory_order_relaxed);
+		}
+		slotSequences[slot].store(sequence + 2, std::memory_order_release);
+
+		chunkSlots[chunk].store(slot, std::memory_order_release);
+		slotReferenced[slot].store(1, std::memory_order_relaxed);
+		chunkLoads.fetch_add(1, std::memory_order_relaxed);
+		return slot;
+	}
+
+	int GridPager::findVictim()
+	{
+		// Clock: take an empty slot, or the first one not read since the hand last passed it. Two turns always find one.
+		while (true)
+		{
+			size_t slot = clockHand;
+			clockHand = (clockHand + 1) % slotCount;
+			if (slotChunks[slot].load(std::memory_order_relaxed) < 0 || slotReferenced[slot].load(std::memory_order_relaxed) == 0)
+			{
+				return (int)slot;
+			}
+			slotReferenced[slot].store(0, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "GridFile.h"
+#include <atomic>
+#include <mutex>
+
+namespace VulkanProject
+{
+	// Barrier bits of a tiled grid file (see GridFile), paged in a chunk at a time. Chunks are copied out of the
+	// mapped file into a fixed pool of slots sized by the memory budget; once the pool is full, a clock sweep evicts
+	// a chunk that has not been read since the hand last passed it. The file pages behind a copied chunk are clean
+	// and left to the OS to reclaim.
+	// Reads may come from any number of threads without locking: every slot has a sequence number that a load
+	// makes odd while refilling it, and a reader that saw it odd or changed retries. Only loading a missing chunk
+	// takes the lock.
+	// Edits go to the copy-on-write mapping as well as to a resident copy, so a chunk reloaded later keeps them.
+	class GridPager
+	{
+	public:
+		struct Counters
+		{
+			// Reads that found their chunk missing; threads missing the same chunk at once share one load
+			size_t pageFaults;
+			size_t chunkLoads;
+			size_t evictions;
+			size_t residentChunks;
+		};
+
+		GridPager();
+		~GridPager();
+		// Pages 'file', which must stay open and tiled, using at most 'memoryBudget' bytes of chunk copies
+		void attach(const GridFile& file, size_t memoryBudget);
+		void detach();
+		bool isAttached() const;
+		int getChunkSize() const;
+		bool isBarrier(int x, int y);
+		// Word 'word' of row y in the layout of Grid::getBarrierRow
+		uint64_t getWord(int y, int word);
+		void setBarrier(int x, int y, bool barrier);
+		Counters getCounters() const;
+		void resetCounters();
+
+		// Even a tiny budget keeps this many chunks resident, so a 3x3 neighbourhood never evicts itself
+		static constexpr size_t MIN_SLOTS = 16;
+
+	private:
+		uint64_t readWord(int chunk, int offset);
+		int loadChunk(int chunk);
+		int findVictim();
+
+		uint64_t* fileBits = nullptr;
+		int width = 0;
+		int height = 0;
+		int chunkSize = 0;
+		int chunkShift = 0;
+		int chunkColumns = 0;
+		// Words per row of a chunk, and per chunk
+		int chunkRowWords = 0;
+		int chunkWords = 0;
+		size_t slotCount = 0;
+		// Copies of the resident chunks, 'chunkWords' words per slot
+		std::vector<uint64_t> slotBits;
+		// Chunk held by each slot and slot holding each chunk, -1 for none
+		std::vector<std::atomic<int>> slotChunks;
+		std::vector<std::atomic<int>> chunkSlots;
+		// Set on every read, cleared by the clock hand
+		std::vector<std::atomic<uint8_t>> slotReferenced;
+		// Bumped before and after a slot is refilled, so odd while its words are being copied
+		std::vector<std::atomic<uint32_t>> slotSequences;
+		size_t clockHand = 0;
+		std::mutex loadMutex;
+
+		std::atomic<size_t> pageFaults;
+		std::atomic<size_t> chunkLoads;
+		std::atomic<size_t> evictions;
+		std::atomic<size_t> residentChunks;
+	};
+}
@@ -0,0 +1,599 @@
+#include "HierarchicalSearch.h"
+
+namespace VulkanProject
+{
+	HierarchicalSearch::HierarchicalSearch(int clusterSize)
+	{
+		this->clusterSize = std::max(clusterSize, 2);
+	}
+
+	HierarchicalSearch::~HierarchicalSearch()
+	{
+	}
+
+	void HierarchicalSearch::build()
+	{
+		// Make sure the barrier file has been loaded before partitioning the grid
+		Grid::ensureLoaded();
+
+		clusterColumns = (Grid::getWidth() + clusterSize - 1) / clusterSize;
+		clusterRows = (Grid::getHeight() + clusterSize - 1) / clusterSize;
+		clusters.assign((size_t)clusterColumns * clusterRows, Cluster());
+		for (int row = 0; row < clusterRows; row++)
+		{
+			for (int column = 0; column < clusterColumns; column++)
+			{
+				Cluster& cluster = clusters[(size_t)row * clusterColumns + column];
+				cluster.minX = column * clusterSize;
+				cluster.minY = row * clusterSize;
+				cluster.maxX = std::min(cluster.minX + clusterSize, Grid::getWidth()) - 1;
+				cluster.maxY = std::min(cluster.minY + clusterSize, Grid::getHeight()) - 1;
+			}
+		}
+
+		// Link every pair of touching clusters once: right, below and both lower diagonals
+		for (int row = 0; row < clusterRows; row++)
+		{
+			for (int column = 0; column < clusterColumns; column++)
+			{
+				int cluster = row * clusterColumns + column;
+				if (column + 1 < clusterColumns)
+				{
+					linkClusters(cluster, cluster + 1);
+				}
+				if (row + 1 < clusterRows)
+				{
+					linkClusters(cluster, cluster + clusterColumns);
+					if (column + 1 < clusterColumns)
+					{
+						linkClusters(cluster, cluster + clusterColumns + 1);
+					}
+					if (column > 0)
+					{
+						linkClusters(cluster, cluster + clusterColumns - 1);
+					}
+				}
+			}
+		}
+
+		for (int cluster = 0; cluster < (int)clusters.size(); cluster++)
+		{
+			buildClusterGraph(cluster);
+		}
+		assignNodeIds();
+		gridVersion = Grid::getVersion();
+	}
+
+	void HierarchicalSearch::update()
+	{
+		if (gridVersion == Grid::getVersion() && !clusters.empty())
+		{
+			return;
+		}
+
+		std::vector<int> changedTiles = std::vector<int>();
+		if (clusters.empty() || !Grid::getChangesSince(gridVersion, changedTiles))
+		{
+			build();
+			return;
+		}
+
+		rebuildClusters(changedTiles);
+		gridVersion = Grid::getVersion();
+	}
+
+	Path HierarchicalSearch::generatePath(const int start[2], const int goal[2])
+	{
+		Path path = Path(start, goal);
+		expansionCount = 0;
+		generatedCount = 0;
+
+		update();
+
+		// Also rejects start and goal in different regions without touching the abstract graph
+		if (!Grid::areConnected(start[0], start[1], goal[0], goal[1]))
+		{
+			LOG("No Path Found.");
+			abstractOpen.clear();
+			return path;
+		}
+
+		startTile = Grid::indexOf(start[0], start[1]);
+		goalTile = Grid::indexOf(goal[0], goal[1]);
+		if (!isWalkable(startTile) || !isWalkable(goalTile))
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		int startCluster = clusterOf(startTile);
+		int goalCluster = clusterOf(goalTile);
+		int startId = (int)nodeTiles.size();
+		int goalId = startId + 1;
+
+		// Connect the start and goal to the entrances of their own clusters
+		const Cluster& first = clusters[startCluster];
+		searchCluster(first, startTile, -1);
+		startDistances.resize(first.nodes.size());
+		for (size_t i = 0; i < first.nodes.size(); i++)
+		{
+			startDistances[i] = getClusterDistance(first, first.nodes[i]);
+		}
+		double directDistance = (startCluster == goalCluster) ? getClusterDistance(first, goalTile) : NodeTable::UNREACHED;
+
+		const Cluster& last = clusters[goalCluster];
+		searchCluster(last, goalTile, -1);
+		goalDistances.resize(last.nodes.size());
+		for (size_t i = 0; i < last.nodes.size(); i++)
+		{
+			goalDistances[i] = getClusterDistance(last, last.nodes[i]);
+		}
+
+		abstractNodes.beginQuery(goalId + 1);
+		abstractOpen.resize(goalId + 1);
+		abstractNodes.open(startId, 0, NodeTable::NO_PARENT);
+		abstractOpen.push(startId, estimateDistance(startTile, goalTile));
+
+		bool found = false;
+		while (!abstractOpen.empty())
+		{
+			int id = abstractOpen.pop();
+			expansionCount++;
+			if (id == goalId)
+			{
+				found = true;
+				break;
+			}
+			abstractNodes.close(id);
+
+			if (id == startId)
+			{
+				for (size_t i = 0; i < startDistances.size(); i++)
+				{
+					relaxAbstract(startId, nodeOffsets[startCluster] + (int)i, startDistances[i]);
+				}
+				relaxAbstract(startId, goalId, directDistance);
+				continue;
+			}
+
+			int cluster = nodeClusters[id];
+			int local = id - nodeOffsets[cluster];
+			const Cluster& current = clusters[cluster];
+			size_t nodeCount = current.nodes.size();
+
+			// Precomputed paths to the other entrances of this cluster
+			for (size_t j = 0; j < nodeCount; j++)
+			{
+				relaxAbstract(id, nodeOffsets[cluster] + (int)j, current.distances[local * nodeCount + j]);
+			}
+
+			// Steps across the border into neighboring clusters
+			for (const Transition& transition : current.transitions)
+			{
+				if (transition.from == nodeTiles[id])
+				{
+					relaxAbstract(id, findNodeId(clusterOf(transition.to), transition.to), transition.cost);
+				}
+			}
+
+			if (cluster == goalCluster)
+			{
+				relaxAbstract(id, goalId, goalDistances[local]);
+			}
+		}
+
+		if (!found)
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		LOG("Path Found.");
+
+		// Collect the abstract route, then refine each leg inside its cluster
+		std::vector<int> route = std::vector<int>();
+		for (int id = goalId; id != NodeTable::NO_PARENT; id = abstractNodes.getParent(id))
+		{
+			route.push_back(tileOf(id));
+		}
+		std::reverse(route.begin(), route.end());
+
+		std::vector<Tile> sequence = std::vector<Tile>();
+		for (size_t i = 1; i < route.size(); i++)
+		{
+			int fromCluster = clusterOf(route[i - 1]);
+			if (fromCluster != clusterOf(route[i]))
+			{
+				sequence.push_back(Grid::at(route[i]));
+			}
+			else
+			{
+				appendClusterPath(clusters[fromCluster], route[i - 1], route[i], sequence);
+			}
+		}
+		path.setSequence(std::move(sequence));
+		return path;
+	}
+
+	size_t HierarchicalSearch::getAbstractNodeCount() const
+	{
+		return nodeTiles.size();
+	}
+
+	size_t HierarchicalSearch::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	void HierarchicalSearch::setCounting(bool counting)
+	{
+		this->counting = counting;
+		abstractOpen.setCounting(counting);
+	}
+
+	void HierarchicalSearch::addStats(SearchStats& stats) const
+	{
+		stats.nodesExpanded += expansionCount;
+		stats.nodesGenerated += generatedCount;
+		abstractOpen.addStats(stats);
+	}
+
+	int HierarchicalSearch::clusterOf(int tile) const
+	{
+		int x = tile % Grid::getWidth();
+		int y = tile / Grid::getWidth();
+		return (y / clusterSize) * clusterColumns + x / clusterSize;
+	}
+
+	int HierarchicalSearch::findNeighborClusters(int cluster, int neighbors[Grid::DIRECTION_COUNT]) const
+	{
+		int column = cluster % clusterColumns;
+		int row = cluster / clusterColumns;
+		int count = 0;
+		for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+		{
+			int neighborColumn = column + Grid::DIRECTION_X[direction];
+			int neighborRow = row + Grid::DIRECTION_Y[direction];
+			if (neighborColumn >= 0 && neighborRow >= 0 && neighborColumn < clusterColumns && neighborRow < clusterRows)
+			{
+				neighbors[count++] = neighborRow * clusterColumns + neighborColumn;
+			}
+		}
+		return count;
+	}
+
+	void HierarchicalSearch::linkClusters(int first, int second)
+	{
+		Cluster& a = clusters[first];
+		Cluster& b = clusters[second];
+		int dx = (second % clusterColumns) - (first % clusterColumns);
+		int dy = (second / clusterColumns) - (first / clusterColumns);
+
+		if (dx < 0 || (dx == 0 && dy < 0))
+		{
+			linkClusters(second, first);
+		}
+		else if (dy == 0)
+		{
+			// 'b' is to the right: scan the shared vertical border
+			linkBorder(a, b, a.maxX, a.minY, b.minX, b.minY, 0, 1, a.maxY - a.minY + 1);
+		}
+		else if (dx == 0)
+		{
+			// 'b' is below: scan the shared horizontal border
+			linkBorder(a, b, a.minX, a.maxY, b.minX, b.minY, 1, 0, a.maxX - a.minX + 1);
+		}
+		else
+		{
+			// Diagonal neighbors only touch at a corner, crossed by a single diagonal step
+			int fromTile = Grid::indexOf(a.maxX, dy > 0 ? a.maxY : a.minY);
+			int toTile = Grid::indexOf(b.minX, dy > 0 ? b.minY : b.maxY);
+			if (isWalkable(fromTile) && isWalkable(toTile))
+			{
+				addTransition(a, b, fromTile, toTile, sqrt(2.0));
+			}
+		}
+	}
+
+	void HierarchicalSearch::linkBorder(Cluster& first, Cluster& second, int firstX, int firstY, int secondX, int secondY, int stepX, int stepY, int length)
+	{
+		auto firstTile = [&](int i) { return Grid::indexOf(firstX + i * stepX, firstY + i * stepY); };
+		auto secondTile = [&](int i) { return Grid::indexOf(secondX + i * stepX, secondY + i * stepY); };
+		auto isOpen = [&](int i) { return isWalkable(firstTile(i)) && isWalkable(secondTile(i)); };
+
+		// Each maximal run of facing open tiles is one entrance
+		int i = 0;
+		while (i < length)
+		{
+			if (!isOpen(i))
+			{
+				i++;
+				continue;
+			}
+
+			int runStart = i;
+			while (i < length && isOpen(i))
+			{
+				i++;
+			}
+			int runEnd = i - 1;
+
+			if (runEnd - runStart + 1 > LONG_ENTRANCE)
+			{
+				addTransition(first, second, firstTile(runStart), secondTile(runStart), 1.0);
+				addTransition(first, second, firstTile(runEnd), secondTile(runEnd), 1.0);
+			}
+			else
+			{
+				int middle = (runStart + runEnd) / 2;
+				addTransition(first, second, firstTile(middle), secondTile(middle), 1.0);
+			}
+		}
+
+		// Diagonal steps across the border are only missing from the entrances above when neither
+		// straight tile beside them is open, so those squeezes get a transition of their own
+		for (i = 0; i + 1 < length; i++)
+		{
+			bool firstOpen = isWalkable(firstTile(i));
+			bool firstNextOpen = isWalkable(firstTile(i + 1));
+			bool secondOpen = isWalkable(secondTile(i));
+			bool secondNextOpen = isWalkable(secondTile(i + 1));
+
+			if (firstOpen && secondNextOpen && !secondOpen && !firstNextOpen)
+			{
+				addTransition(first, second, firstTile(i), secondTile(i + 1), sqrt(2.0));
+			}
+			if (firstNextOpen && secondOpen && !firstOpen && !secondNextOpen)
+			{
+				addTransition(first, second, firstTile(i + 1), secondTile(i), sqrt(2.0));
+			}
+		}
+	}
+
+	void HierarchicalSearch::addTransition(Cluster& first, Cluster& second, int firstTile, int secondTile, double cost)
+	{
+		first.transitions.push_back(Transition{ firstTile, secondTile, cost });
+		second.transitions.push_back(Transition{ secondTile, firstTile, cost });
+	}
+
+	void HierarchicalSearch::buildClusterGraph(int cluster)
+	{
+		Cluster& current = clusters[cluster];
+
+		current.nodes.clear();
+		for (const Transition& transition : current.transitions)
+		{
+			current.nodes.push_back(transition.from);
+		}
+		std::sort(current.nodes.begin(), current.nodes.end());
+		current.nodes.erase(std::unique(current.nodes.begin(), current.nodes.end()), current.nodes.end());
+
+		size_t nodeCount = current.nodes.size();
+		current.distances.assign(nodeCount * nodeCount, NodeTable::UNREACHED);
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			searchCluster(current, current.nodes[i], -1);
+			for (size_t j = 0; j < nodeCount; j++)
+			{
+				if (i != j)
+				{
+					current.distances[i * nodeCount + j] = getClusterDistance(current, current.nodes[j]);
+				}
+			}
+		}
+	}
+
+	void HierarchicalSearch::rebuildClusters(const std::vector<int>& changedTiles)
+	{
+		std::vector<char> dirty = std::vector<char>(clusters.size(), 0);
+		std::vector<int> dirtyClusters = std::vector<int>();
+		for (int tile : changedTiles)
+		{
+			int cluster = clusterOf(tile);
+			if (!dirty[cluster])
+			{
+				dirty[cluster] = 1;
+				dirtyClusters.push_back(cluster);
+			}
+		}
+
+		int neighbors[Grid::DIRECTION_COUNT];
+
+		// Drop every transition that touches a dirty cluster, from both sides of the border
+		for (int cluster : dirtyClusters)
+		{
+			clusters[cluster].transitions.clear();
+		}
+		for (int cluster : dirtyClusters)
+		{
+			int neighborCount = findNeighborClusters(cluster, neighbors);
+			for (int i = 0; i < neighborCount; i++)
+			{
+				if (dirty[neighbors[i]])
+				{
+					continue;
+				}
+				std::vector<Transition>& transitions = clusters[neighbors[i]].transitions;
+				transitions.erase(std::remove_if(transitions.begin(), transitions.end(),
+					[&](const Transition& transition) { return clusterOf(transition.to) == cluster; }), transitions.end());
+			}
+		}
+
+		// Relink those borders (once per pair) and rebuild the graphs of every cluster whose entrances may have moved
+		std::vector<int> affectedClusters = dirtyClusters;
+		for (int cluster : dirtyClusters)
+		{
+			int neighborCount = findNeighborClusters(cluster, neighbors);
+			for (int i = 0; i < neighborCount; i++)
+			{
+				if (!dirty[neighbors[i]] || cluster < neighbors[i])
+				{
+					linkClusters(cluster, neighbors[i]);
+				}
+				affectedClusters.push_back(neighbors[i]);
+			}
+		}
+		std::sort(affectedClusters.begin(), affectedClusters.end());
+		affectedClusters.erase(std::unique(affectedClusters.begin(), affectedClusters.end()), affectedClusters.end());
+
+		for (int cluster : affectedClusters)
+		{
+			buildClusterGraph(cluster);
+		}
+		assignNodeIds();
+	}
+
+	void HierarchicalSearch::assignNodeIds()
+	{
+		nodeOffsets.resize(clusters.size());
+		nodeTiles.clear();
+		nodeClusters.clear();
+		for (int cluster = 0; cluster < (int)clusters.size(); cluster++)
+		{
+			nodeOffsets[cluster] = (int)nodeTiles.size();
+			for (int tile : clusters[cluster].nodes)
+			{
+				nodeTiles.push_back(tile);
+				nodeClusters.push_back(cluster);
+			}
+		}
+	}
+
+	void HierarchicalSearch::searchCluster(const Cluster& cluster, int sourceTile, int targetTile)
+	{
+		// Dijkstra confined to the cluster; with a target it stops as soon as the target is settled
+		int width = Grid::getWidth();
+		auto localIndex = [&](int x, int y) { return (y - cluster.minY) * clusterSize + (x - cluster.minX); };
+
+		localNodes.beginQuery(clusterSize * clusterSize);
+		localOpen.resize(clusterSize * clusterSize);
+
+		int source = localIndex(sourceTile % width, sourceTile / width);
+		localNodes.open(source, 0, NodeTable::NO_PARENT);
+		localOpen.push(source, 0);
+
+		int target = (targetTile >= 0) ? localIndex(targetTile % width, targetTile / width) : -1;
+		while (!localOpen.empty())
+		{
+			int current = localOpen.pop();
+			localNodes.close(current);
+			if (current == target)
+			{
+				return;
+			}
+
+			int x = cluster.minX + current % clusterSize;
+			int y = cluster.minY + current / clusterSize;
+			double currentG = localNodes.getG(current);
+			for (Tile neighbor : Grid::neighbors(x, y))
+			{
+				if (neighbor.getX() < cluster.minX || neighbor.getX() > cluster.maxX ||
+					neighbor.getY() < cluster.minY || neighbor.getY() > cluster.maxY)
+				{
+					continue;
+				}
+
+				int next = localIndex(neighbor.getX(), neighbor.getY());
+				NodeTable::NodeState state = localNodes.getState(next);
+				double g = currentG + ((neighbor.getX() != x && neighbor.getY() != y) ? sqrt(2.0) : 1.0);
+				if (state == NodeTable::NodeState::CLOSED || g >= localNodes.getG(next))
+				{
+					continue;
+				}
+
+				localNodes.open(next, g, current);
+				if (state == NodeTable::NodeState::OPEN)
+				{
+					localOpen.decreaseKey(next, g);
+				}
+				else
+				{
+					localOpen.push(next, g);
+				}
+			}
+		}
+	}
+
+	double HierarchicalSearch::getClusterDistance(const Cluster& cluster, int tile) const
+	{
+		int x = tile % Grid::getWidth();
+		int y = tile / Grid::getWidth();
+		return localNodes.getG((y - cluster.minY) * clusterSize + (x - cluster.minX));
+	}
+
+	void HierarchicalSearch::appendClusterPath(const Cluster& cluster, int fromTile, int toTile, std::vector<Tile>& sequence)
+	{
+		searchCluster(cluster, fromTile, toTile);
+
+		// Walk the parents back from the target, then flip the appended run into travel order
+		size_t legStart = sequence.size();
+		int x = toTile % Grid::getWidth();
+		int y = toTile / Grid::getWidth();
+		int source = (fromTile / Grid::getWidth() - cluster.minY) * clusterSize + (fromTile % Grid::getWidth() - cluster.minX);
+		for (int local = (y - cluster.minY) * clusterSize + (x - cluster.minX); local != source; local = localNodes.getParent(local))
+		{
+			sequence.push_back(Grid::at(cluster.minX + local % clusterSize, cluster.minY + local / clusterSize));
+		}
+		std::reverse(sequence.begin() + legStart, sequence.end());
+	}
+
+	void HierarchicalSearch::relaxAbstract(int fromId, int toId, double cost)
+	{
+		if (cost == NodeTable::UNREACHED || fromId == toId)
+		{
+			return;
+		}
+
+		SEARCH_STATS_COUNT(counting, generatedCount);
+		NodeTable::NodeState state = abstractNodes.getState(toId);
+		double g = abstractNodes.getG(fromId) + cost;
+		if (state == NodeTable::NodeState::CLOSED || g >= abstractNodes.getG(toId))
+		{
+			return;
+		}
+
+		abstractNodes.open(toId, g, fromId);
+		double f = g + estimateDistance(tileOf(toId), goalTile);
+		if (state == NodeTable::NodeState::OPEN)
+		{
+			abstractOpen.decreaseKey(toId, f);
+		}
+		else
+		{
+			abstractOpen.push(toId, f);
+		}
+	}
+
+	int HierarchicalSearch::findNodeId(int cluster, int tile) const
+	{
+		const std::vector<int>& nodes = clusters[cluster].nodes;
+		return nodeOffsets[cluster] + (int)(std::lower_bound(nodes.begin(), nodes.end(), tile) - nodes.begin());
+	}
+
+	int HierarchicalSearch::tileOf(int id) const
+	{
+		int nodeCount = (int)nodeTiles.size();
+		if (id == nodeCount)
+		{
+			return startTile;
+		}
+		if (id == nodeCount + 1)
+		{
+			return goalTile;
+		}
+		return nodeTiles[id];
+	}
+
+	double HierarchicalSearch::estimateDistance(int tile, int targetTile) const
+	{
+		// Octile distance never overestimates the cost of an 8-connected path
+		int dx = abs(tile % Grid::getWidth() - targetTile % Grid::getWidth());
+		int dy = abs(tile / Grid::getWidth() - targetTile / Grid::getWidth());
+		return sqrt(2.0) * std::min(dx, dy) + abs(dx - dy);
+	}
+
+	bool HierarchicalSearch::isWalkable(int tile) const
+	{
+		return !Grid::isBarrier(tile % Grid::getWidth(), tile / Grid::getWidth());
+	}
+}
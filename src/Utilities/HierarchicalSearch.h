@@ -0,0 +1,96 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "NodeTable.h"
+#include "Path.h"
+
+namespace VulkanProject
+{
+	// HPA*: the grid is split into square clusters, entrances are found along every shared border and the
+	// distances between entrances inside each cluster are precomputed. A query searches that small abstract
+	// graph first and then refines only the clusters along the chosen corridor. Paths are near-optimal.
+	class HierarchicalSearch
+	{
+	public:
+		HierarchicalSearch(int clusterSize = 16);
+		~HierarchicalSearch();
+		// Builds the abstraction for the grid as it is now
+		void build();
+		// Applies barrier edits made since the last build/update, rebuilding only the clusters they touch
+		void update();
+		Path generatePath(const int start[2], const int goal[2]);
+		size_t getAbstractNodeCount() const;
+		// Abstract nodes expanded by the most recent query
+		size_t getExpansionCount() const;
+		// Abstract edges and heap operations are only counted while counting is on (see SEARCH_STATS_COUNT)
+		void setCounting(bool counting);
+		// Adds the most recent query's abstract search counts; refining the corridor is not counted
+		void addStats(SearchStats& stats) const;
+
+	private:
+		// A move from a tile in this cluster to a tile in a neighboring one
+		struct Transition
+		{
+			int from;
+			int to;
+			double cost;
+		};
+
+		struct Cluster
+		{
+			int minX;
+			int minY;
+			int maxX;
+			int maxY;
+			std::vector<Transition> transitions;
+			// Sorted, unique entrance tiles of this cluster
+			std::vector<int> nodes;
+			// nodes.size() x nodes.size() shortest distances staying inside the cluster
+			std::vector<double> distances;
+		};
+
+		// Entrances longer than this get a transition at each end instead of one in the middle
+		static const int LONG_ENTRANCE = 6;
+
+		int clusterOf(int tile) const;
+		int findNeighborClusters(int cluster, int neighbors[Grid::DIRECTION_COUNT]) const;
+		void linkClusters(int first, int second);
+		void linkBorder(Cluster& first, Cluster& second, int firstX, int firstY, int secondX, int secondY, int stepX, int stepY, int length);
+		void addTransition(Cluster& first, Cluster& second, int firstTile, int secondTile, double cost);
+		void buildClusterGraph(int cluster);
+		void rebuildClusters(const std::vector<int>& changedTiles);
+		void assignNodeIds();
+		void searchCluster(const Cluster& cluster, int sourceTile, int targetTile);
+		double getClusterDistance(const Cluster& cluster, int tile) const;
+		void appendClusterPath(const Cluster& cluster, int fromTile, int toTile, std::vector<Tile>& sequence);
+		void relaxAbstract(int fromId, int toId, double cost);
+		int findNodeId(int cluster, int tile) const;
+		int tileOf(int id) const;
+		double estimateDistance(int tile, int targetTile) const;
+		bool isWalkable(int tile) const;
+
+		int clusterSize;
+		int clusterColumns = 0;
+		int clusterRows = 0;
+		std::vector<Cluster> clusters;
+		// Abstract node ids are nodeOffsets[cluster] + position in that cluster's node list
+		std::vector<int> nodeOffsets;
+		std::vector<int> nodeTiles;
+		std::vector<int> nodeClusters;
+		uint64_t gridVersion = 0;
+
+		// Scratch for searches confined to one cluster, indexed by position inside the cluster
+		NodeTable localNodes;
+		IndexedHeap localOpen;
+		// Scratch for the abstract search; the two ids past the last node are the query's start and goal
+		NodeTable abstractNodes;
+		IndexedHeap abstractOpen;
+		std::vector<double> startDistances;
+		std::vector<double> goalDistances;
+		int startTile = 0;
+		int goalTile = 0;
+		size_t expansionCount = 0;
+		size_t generatedCount = 0;
+		bool counting = false;
+	};
+}
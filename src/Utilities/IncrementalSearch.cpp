@@ -0,0 +1,345 @@
+#include "IncrementalSearch.h"
+#include "NodeTable.h"
+
+namespace VulkanProject
+{
+	IncrementalSearch::IncrementalSearch()
+	{
+	}
+
+	IncrementalSearch::~IncrementalSearch()
+	{
+	}
+
+	Path IncrementalSearch::generatePath(const int start[2], const int goal[2])
+	{
+		Path path = Path(start, goal);
+		Grid::ensureLoaded();
+		expansionCount = 0;
+
+		if (!Grid::inBounds(start[0], start[1]) || !Grid::inBounds(goal[0], goal[1]))
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		int newStart = Grid::indexOf(start[0], start[1]);
+		int newGoal = Grid::indexOf(goal[0], goal[1]);
+		if (newStart == newGoal)
+		{
+			LOG("Path Found.");
+			path.setSequence(std::vector<Tile>());
+			return path;
+		}
+
+		// Keep the previous search only while it still describes this grid and this goal
+		changedTiles.clear();
+		bool reusable = planned && newGoal == goalIndex && Grid::getWidth() == gridWidth && Grid::getHeight() == gridHeight &&
+			Grid::getChangesSince(gridVersion, changedTiles);
+		if (reusable)
+		{
+			// Queued keys were computed for the old start; raising every new key by the distance moved keeps them comparable
+			keyModifier += estimateDistance(startIndex, newStart);
+			startIndex = newStart;
+			applyChanges(changedTiles);
+		}
+		else
+		{
+			startIndex = newStart;
+			initialize(newGoal);
+		}
+		gridVersion = Grid::getVersion();
+		planned = true;
+
+		computeShortestPath();
+
+		if (getG(startIndex) == NodeTable::UNREACHED)
+		{
+			LOG("No Path Found.");
+			return path;
+		}
+
+		LOG("Path Found.");
+		buildSequence(path);
+		return path;
+	}
+
+	void IncrementalSearch::reset()
+	{
+		planned = false;
+	}
+
+	size_t IncrementalSearch::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	void IncrementalSearch::initialize(int goalIndex)
+	{
+		this->goalIndex = goalIndex;
+		gridWidth = Grid::getWidth();
+		gridHeight = Grid::getHeight();
+
+		int nodeCount = gridWidth * gridHeight;
+		if ((int)stamps.size() != nodeCount)
+		{
+			gValues.resize(nodeCount);
+			rhsValues.resize(nodeCount);
+			stamps.assign(nodeCount, 0);
+			generation = 0;
+		}
+
+		// Same trick as NodeTable: a new generation hides every value from the previous plan
+		generation++;
+		if (generation == 0)
+		{
+			std::fill(stamps.begin(), stamps.end(), 0);
+			generation = 1;
+		}
+		openNodes.resize(nodeCount);
+		keyModifier = 0;
+
+		setRhs(goalIndex, 0);
+		updateVertex(goalIndex);
+	}
+
+	void IncrementalSearch::applyChanges(const std::vector<int>& changedTiles)
+	{
+		// An edit changes the cost of every move into the edited tile, i.e. one outgoing move of each neighbor
+		for (int tile : changedTiles)
+		{
+			int tileX = tile % gridWidth;
+			int tileY = tile / gridWidth;
+			for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+			{
+				int neighborX = tileX + Grid::DIRECTION_X[direction];
+				int neighborY = tileY + Grid::DIRECTION_Y[direction];
+				if (!Grid::inBounds(neighborX, neighborY))
+				{
+					continue;
+				}
+
+				int neighbor = Grid::indexOf(neighborX, neighborY);
+				if (neighbor != goalIndex)
+				{
+					setRhs(neighbor, computeRhs(neighbor));
+					updateVertex(neighbor);
+				}
+			}
+		}
+	}
+
+	void IncrementalSearch::computeShortestPath()
+	{
+		while (!openNodes.empty())
+		{
+			int current = openNodes.top();
+			double topKey = openNodes.getKey(current);
+			double topSecondKey = openNodes.getSecondKey(current);
+
+			// Done once nothing queued can still improve the start and the start itself is settled
+			double startMinimum = std::min(getG(startIndex), getRhs(startIndex));
+			double startKey = startMinimum + keyModifier;
+			bool topBeforeStart = topKey < startKey || (topKey == startKey && topSecondKey < startMinimum);
+			if (!topBeforeStart && getRhs(startIndex) == getG(startIndex))
+			{
+				break;
+			}
+			expansionCount++;
+
+			// Keys queued before the start moved may be stale; requeue with the current one
+			double minimum = std::min(getG(current), getRhs(current));
+			double key = minimum + estimateDistance(startIndex, current) + keyModifier;
+			if (topKey < key || (topKey == key && topSecondKey < minimum))
+			{
+				openNodes.update(current, key, minimum);
+				continue;
+			}
+
+			int currentX = current % gridWidth;
+			int currentY = current / gridWidth;
+			if (getG(current) > getRhs(current))
+			{
+				// Overconsistent: settle the tile and offer it to every tile that can move into it
+				setG(current, getRhs(current));
+				openNodes.remove(current);
+				for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+				{
+					int neighborX = currentX + Grid::DIRECTION_X[direction];
+					int neighborY = currentY + Grid::DIRECTION_Y[direction];
+					if (!Grid::inBounds(neighborX, neighborY))
+					{
+						continue;
+					}
+
+					int neighbor = Grid::indexOf(neighborX, neighborY);
+					double rhs = stepCost(neighbor, current) + getG(current);
+					if (neighbor != goalIndex && rhs < getRhs(neighbor))
+					{
+						setRhs(neighbor, rhs);
+						updateVertex(neighbor);
+					}
+				}
+			}
+			else
+			{
+				// Underconsistent: the tile got more expensive, so everything that relied on it has to look again
+				double oldG = getG(current);
+				setG(current, NodeTable::UNREACHED);
+				for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+				{
+					int neighborX = currentX + Grid::DIRECTION_X[direction];
+					int neighborY = currentY + Grid::DIRECTION_Y[direction];
+					if (!Grid::inBounds(neighborX, neighborY))
+					{
+						continue;
+					}
+
+					int neighbor = Grid::indexOf(neighborX, neighborY);
+					if (neighbor != goalIndex && getRhs(neighbor) == stepCost(neighbor, current) + oldG)
+					{
+						setRhs(neighbor, computeRhs(neighbor));
+					}
+					updateVertex(neighbor);
+				}
+				if (current != goalIndex)
+				{
+					setRhs(current, computeRhs(current));
+				}
+				updateVertex(current);
+			}
+		}
+	}
+
+	void IncrementalSearch::updateVertex(int node)
+	{
+		double g = getG(node);
+		double rhs = getRhs(node);
+		if (g == rhs)
+		{
+			if (openNodes.contains(node))
+			{
+				openNodes.remove(node);
+			}
+			return;
+		}
+
+		// Keys compare by estimated total first, then by the smaller of g and rhs
+		double minimum = std::min(g, rhs);
+		double key = minimum + estimateDistance(startIndex, node) + keyModifier;
+		if (openNodes.contains(node))
+		{
+			openNodes.update(node, key, minimum);
+		}
+		else
+		{
+			openNodes.push(node, key, minimum);
+		}
+	}
+
+	double IncrementalSearch::computeRhs(int node) const
+	{
+		int nodeX = node % gridWidth;
+		int nodeY = node / gridWidth;
+		double best = NodeTable::UNREACHED;
+		for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+		{
+			int neighborX = nodeX + Grid::DIRECTION_X[direction];
+			int neighborY = nodeY + Grid::DIRECTION_Y[direction];
+			if (Grid::inBounds(neighborX, neighborY))
+			{
+				int neighbor = Grid::indexOf(neighborX, neighborY);
+				best = std::min(best, stepCost(node, neighbor) + getG(neighbor));
+			}
+		}
+		return best;
+	}
+
+	double IncrementalSearch::getG(int node) const
+	{
+		return stamps[node] == generation ? gValues[node] : NodeTable::UNREACHED;
+	}
+
+	double IncrementalSearch::getRhs(int node) const
+	{
+		return stamps[node] == generation ? rhsValues[node] : NodeTable::UNREACHED;
+	}
+
+	void IncrementalSearch::setG(int node, double g)
+	{
+		if (stamps[node] != generation)
+		{
+			stamps[node] = generation;
+			rhsValues[node] = NodeTable::UNREACHED;
+		}
+		gValues[node] = g;
+	}
+
+	void IncrementalSearch::setRhs(int node, double rhs)
+	{
+		if (stamps[node] != generation)
+		{
+			stamps[node] = generation;
+			gValues[node] = NodeTable::UNREACHED;
+		}
+		rhsValues[node] = rhs;
+	}
+
+	double IncrementalSearch::stepCost(int from, int to) const
+	{
+		// Moving into a barrier is impossible; leaving one is allowed, like every other search mode
+		if (Grid::isBarrier(to % gridWidth, to / gridWidth))
+		{
+			return NodeTable::UNREACHED;
+		}
+		bool diagonal = (from % gridWidth != to % gridWidth) && (from / gridWidth != to / gridWidth);
+		return diagonal ? DIAGONAL_COST : ORTHOGONAL_COST;
+	}
+
+	double IncrementalSearch::estimateDistance(int from, int to) const
+	{
+		// Octile distance, which never overestimates the cost of 8-connected moves
+		int dx = abs(from % gridWidth - to % gridWidth);
+		int dy = abs(from / gridWidth - to / gridWidth);
+		return DIAGONAL_COST * std::min(dx, dy) + ORTHOGONAL_COST * abs(dx - dy);
+	}
+
+	void IncrementalSearch::buildSequence(Path& path)
+	{
+		// g holds the exact remaining cost along the solution, so stepping to the cheapest neighbor walks it
+		std::vector<Tile> sequence = std::vector<Tile>();
+		int node = startIndex;
+		for (int steps = 0; node != goalIndex && steps < gridWidth * gridHeight; steps++)
+		{
+			int nodeX = node % gridWidth;
+			int nodeY = node / gridWidth;
+			int next = -1;
+			double best = NodeTable::UNREACHED;
+			for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+			{
+				int neighborX = nodeX + Grid::DIRECTION_X[direction];
+				int neighborY = nodeY + Grid::DIRECTION_Y[direction];
+				if (!Grid::inBounds(neighborX, neighborY))
+				{
+					continue;
+				}
+
+				int neighbor = Grid::indexOf(neighborX, neighborY);
+				double cost = stepCost(node, neighbor) + getG(neighbor);
+				if (cost < best)
+				{
+					best = cost;
+					next = neighbor;
+				}
+			}
+
+			if (next < 0)
+			{
+				break;
+			}
+			node = next;
+			sequence.push_back(Grid::at(node));
+		}
+		path.setSequence(std::move(sequence));
+	}
+}
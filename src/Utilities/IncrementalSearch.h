@@ -0,0 +1,61 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "Path.h"
+
+namespace VulkanProject
+{
+	// D* Lite: searches backwards from the goal and keeps its g/rhs values between calls. While the goal stays
+	// the same, a new call only pulls the barrier edits made since the last one (Grid::getChangesSince), fixes
+	// the rhs values of the tiles next to each edit and repairs the solution from there, so the work done tracks
+	// the size of the change rather than the size of the map. The start may move freely between calls.
+	// Holds the state of one agent's plan; not safe to share between threads.
+	class IncrementalSearch
+	{
+	public:
+		IncrementalSearch();
+		~IncrementalSearch();
+		Path generatePath(const int start[2], const int goal[2]);
+		// Forgets all search state; the next call plans from scratch
+		void reset();
+		// Nodes taken off the open list by the most recent call
+		size_t getExpansionCount() const;
+
+	private:
+		// Costs are whole multiples of 2^-24 tiles so every sum is exact: keys that are equal on paper must compare
+		// equal, or the tie-break on the second key (and with it the stopping test) goes wrong
+		static constexpr double ORTHOGONAL_COST = 1 << 24;
+		static constexpr double DIAGONAL_COST = 23726566;
+
+		void initialize(int goalIndex);
+		void applyChanges(const std::vector<int>& changedTiles);
+		void computeShortestPath();
+		void updateVertex(int node);
+		double computeRhs(int node) const;
+		double getG(int node) const;
+		double getRhs(int node) const;
+		void setG(int node, double g);
+		void setRhs(int node, double rhs);
+		double stepCost(int from, int to) const;
+		double estimateDistance(int from, int to) const;
+		void buildSequence(Path& path);
+
+		// Values are only meaningful where stamps[node] == generation; everything else is unreached
+		std::vector<double> gValues;
+		std::vector<double> rhsValues;
+		std::vector<uint32_t> stamps;
+		uint32_t generation = 0;
+		IndexedHeap openNodes;
+
+		bool planned = false;
+		int startIndex = 0;
+		int goalIndex = 0;
+		int gridWidth = 0;
+		int gridHeight = 0;
+		uint64_t gridVersion = 0;
+		// Heuristic offset that keeps queued keys valid after the start moves
+		double keyModifier = 0;
+		std::vector<int> changedTiles;
+		size_t expansionCount = 0;
+	};
+}
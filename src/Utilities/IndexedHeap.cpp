@@ -0,0 +1,252 @@
+#include "IndexedHeap.h"
+
+namespace VulkanProject
+{
+	IndexedHeap::IndexedHeap()
+	{
+	}
+
+	IndexedHeap::~IndexedHeap()
+	{
+	}
+
+	void IndexedHeap::resize(int nodeCount, bool sparse)
+	{
+		clear();
+		this->sparse = sparse;
+		if (sparse)
+		{
+			positions = std::vector<int>();
+			return;
+		}
+		if ((int)positions.size() != nodeCount)
+		{
+			positions.resize(nodeCount, -1);
+			allocationCount++;
+			allocatedBytes += nodeCount * sizeof(int);
+		}
+	}
+
+	void IndexedHeap::clear()
+	{
+		// Only the nodes still queued carry a position, so this is O(size) rather than O(nodeCount)
+		for (const Entry& entry : heap)
+		{
+			setPosition(entry.node, -1);
+		}
+		heap.clear();
+		pushCount = 0;
+		popCount = 0;
+		decreaseKeyCount = 0;
+		peakSize = 0;
+	}
+
+	bool IndexedHeap::empty() const
+	{
+		return heap.empty();
+	}
+
+	int IndexedHeap::size() const
+	{
+		return (int)heap.size();
+	}
+
+	bool IndexedHeap::contains(int node) const
+	{
+		return getPosition(node) != -1;
+	}
+
+	double IndexedHeap::getKey(int node) const
+	{
+		return heap[getPosition(node)].key;
+	}
+
+	double IndexedHeap::getSecondKey(int node) const
+	{
+		return heap[getPosition(node)].secondKey;
+	}
+
+	int IndexedHeap::top() const
+	{
+		return heap.front().node;
+	}
+
+	int IndexedHeap::pop()
+	{
+		int node = heap.front().node;
+		setPosition(node, -1);
+		SEARCH_STATS_COUNT(counting, popCount);
+
+		Entry last = heap.back();
+		heap.pop_back();
+		if (!heap.empty())
+		{
+			place(0, last);
+			siftDown(0);
+		}
+		return node;
+	}
+
+	void IndexedHeap::push(int node, double key, double secondKey)
+	{
+		bool growing = heap.size() == heap.capacity();
+		heap.push_back(Entry{ key, secondKey, node });
+		if (growing)
+		{
+			allocationCount++;
+			allocatedBytes += heap.capacity() * sizeof(Entry);
+		}
+		setPosition(node, (int)heap.size() - 1);
+		siftUp((int)heap.size() - 1);
+		SEARCH_STATS_COUNT(counting, pushCount);
+		if (counting)
+		{
+			peakSize = std::max(peakSize, heap.size());
+		}
+	}
+
+	void IndexedHeap::decreaseKey(int node, double key, double secondKey)
+	{
+		int position = getPosition(node);
+		SEARCH_STATS_COUNT(counting, decreaseKeyCount);
+		heap[position].key = key;
+		heap[position].secondKey = secondKey;
+		siftUp(position);
+	}
+
+	void IndexedHeap::update(int node, double key, double secondKey)
+	{
+		int position = getPosition(node);
+		SEARCH_STATS_COUNT(counting, decreaseKeyCount);
+		heap[position].key = key;
+		heap[position].secondKey = secondKey;
+		siftUp(position);
+		siftDown(getPosition(node));
+	}
+
+	void IndexedHeap::remove(int node)
+	{
+		int position = getPosition(node);
+		setPosition(node, -1);
+		SEARCH_STATS_COUNT(counting, popCount);
+
+		// Fill the hole with the last entry, which may belong above or below it
+		Entry last = heap.back();
+		heap.pop_back();
+		if (position < (int)heap.size())
+		{
+			place(position, last);
+			siftUp(position);
+			siftDown(getPosition(last.node));
+		}
+	}
+
+	size_t IndexedHeap::getAllocationCount() const
+	{
+		return allocationCount;
+	}
+
+	size_t IndexedHeap::getAllocatedBytes() const
+	{
+		return allocatedBytes;
+	}
+
+	void IndexedHeap::setCounting(bool counting)
+	{
+		this->counting = counting;
+	}
+
+	void IndexedHeap::addStats(SearchStats& stats) const
+	{
+		stats.heapPushes += pushCount;
+		stats.heapPops += popCount;
+		stats.heapDecreaseKeys += decreaseKeyCount;
+		stats.peakOpenSize = std::max(stats.peakOpenSize, peakSize);
+	}
+
+	void IndexedHeap::siftUp(int position)
+	{
+		Entry entry = heap[position];
+		while (position > 0)
+		{
+			int parent = (position - 1) / ARITY;
+			if (!isLess(entry, heap[parent]))
+			{
+				break;
+			}
+			place(position, heap[parent]);
+			position = parent;
+		}
+		place(position, entry);
+	}
+
+	void IndexedHeap::siftDown(int position)
+	{
+		Entry entry = heap[position];
+		int count = (int)heap.size();
+		while (true)
+		{
+			int firstChild = position * ARITY + 1;
+			if (firstChild >= count)
+			{
+				break;
+			}
+
+			// Find the smallest of up to ARITY children
+			int best = firstChild;
+			int lastChild = std::min(firstChild + ARITY, count);
+			for (int child = firstChild + 1; child < lastChild; child++)
+			{
+				if (isLess(heap[child], heap[best]))
+				{
+					best = child;
+				}
+			}
+
+			if (!isLess(heap[best], entry))
+			{
+				break;
+			}
+			place(position, heap[best]);
+			position = best;
+		}
+		place(position, entry);
+	}
+
+	void IndexedHeap::place(int position, Entry entry)
+	{
+		heap[position] = entry;
+		setPosition(entry.node, position);
+	}
+
+	bool IndexedHeap::isLess(const Entry& first, const Entry& second)
+	{
+		return first.key < second.key || (first.key == second.key && first.secondKey < second.secondKey);
+	}
+
+	int IndexedHeap::getPosition(int node) const
+	{
+		if (!sparse)
+		{
+			return positions[node];
+		}
+		auto position = sparsePositions.find(node);
+		return position != sparsePositions.end() ? position->second : -1;
+	}
+
+	void IndexedHeap::setPosition(int node, int position)
+	{
+		if (!sparse)
+		{
+			positions[node] = position;
+		}
+		else if (position == -1)
+		{
+			sparsePositions.erase(node);
+		}
+		else
+		{
+			sparsePositions[node] = position;
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "SearchStats.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace VulkanProject
+{
+	// Min-priority queue of node indices with O(log n) push, pop and decrease-key.
+	// A 4-ary layout keeps the tree shallow and sibling keys on the same cache line.
+	// Entries are ordered by key, then by the optional second key, which breaks ties.
+	// A sparse heap keeps the positions of queued nodes in a hash map instead of an array sized to the grid.
+	class IndexedHeap
+	{
+	public:
+		IndexedHeap();
+		~IndexedHeap();
+		void resize(int nodeCount, bool sparse = false);
+		void clear();
+		bool empty() const;
+		int size() const;
+		bool contains(int node) const;
+		double getKey(int node) const;
+		double getSecondKey(int node) const;
+		int top() const;
+		int pop();
+		void push(int node, double key, double secondKey = 0);
+		void decreaseKey(int node, double key, double secondKey = 0);
+		// Moves a queued node to a key that may be higher or lower than its current one
+		void update(int node, double key, double secondKey = 0);
+		void remove(int node);
+		size_t getAllocationCount() const;
+		// Bytes those buffers grew by in total
+		size_t getAllocatedBytes() const;
+		// Operations are only counted while counting is on (see SEARCH_STATS_COUNT)
+		void setCounting(bool counting);
+		// Adds the operations since the last clear() or resize()
+		void addStats(SearchStats& stats) const;
+
+	private:
+		struct Entry
+		{
+			double key;
+			double secondKey;
+			int node;
+		};
+
+		static const int ARITY = 4;
+
+		void siftUp(int position);
+		void siftDown(int position);
+		void place(int position, Entry entry);
+		static bool isLess(const Entry& first, const Entry& second);
+		int getPosition(int node) const;
+		void setPosition(int node, int position);
+
+		std::vector<Entry> heap;
+		// Position of each node inside 'heap', or -1 when the node is not queued
+		std::vector<int> positions;
+		// Holds only the queued nodes when sparse
+		std::unordered_map<int, int> sparsePositions;
+		bool sparse = false;
+		// Number of times either buffer had to grow
+		size_t allocationCount = 0;
+		size_t allocatedBytes = 0;
+		size_t pushCount = 0;
+		size_t popCount = 0;
+		size_t decreaseKeyCount = 0;
+		size_t peakSize = 0;
+		bool counting = false;
+	};
+}
@@ -0,0 +1,154 @@
+#include "JumpPointSearch.h"
+
+namespace VulkanProject
+{
+	int JumpPointSearch::findSuccessors(int x, int y, int parentIndex, int goalX, int goalY, int successors[MAX_SUCCESSORS])
+	{
+		int directionX[MAX_SUCCESSORS];
+		int directionY[MAX_SUCCESSORS];
+		int directionCount = findNeighborDirections(x, y, parentIndex, directionX, directionY);
+
+		int successorCount = 0;
+		for (int i = 0; i < directionCount; i++)
+		{
+			int jumpX;
+			int jumpY;
+			if (jump(x + directionX[i], y + directionY[i], directionX[i], directionY[i], goalX, goalY, jumpX, jumpY))
+			{
+				successors[successorCount++] = Grid::indexOf(jumpX, jumpY);
+			}
+		}
+		return successorCount;
+	}
+
+	int JumpPointSearch::findNeighborDirections(int x, int y, int parentIndex, int directionX[MAX_SUCCESSORS], int directionY[MAX_SUCCESSORS])
+	{
+		int count = 0;
+		auto add = [&](int dx, int dy)
+		{
+			if (isWalkable(x + dx, y + dy))
+			{
+				directionX[count] = dx;
+				directionY[count] = dy;
+				count++;
+			}
+		};
+
+		// The start tile has no travel direction, so every neighbor is a candidate
+		if (parentIndex < 0)
+		{
+			for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+			{
+				add(Grid::DIRECTION_X[direction], Grid::DIRECTION_Y[direction]);
+			}
+			return count;
+		}
+
+		int parentX = parentIndex % Grid::getWidth();
+		int parentY = parentIndex / Grid::getWidth();
+		int dx = (x > parentX) - (x < parentX);
+		int dy = (y > parentY) - (y < parentY);
+
+		if (dx != 0 && dy != 0)
+		{
+			// Natural neighbors of a diagonal move, plus the two forced ones around blocked corners
+			add(0, dy);
+			add(dx, 0);
+			add(dx, dy);
+			if (!isWalkable(x - dx, y))
+			{
+				add(-dx, dy);
+			}
+			if (!isWalkable(x, y - dy))
+			{
+				add(dx, -dy);
+			}
+		}
+		else if (dx != 0)
+		{
+			add(dx, 0);
+			if (!isWalkable(x, y + 1))
+			{
+				add(dx, 1);
+			}
+			if (!isWalkable(x, y - 1))
+			{
+				add(dx, -1);
+			}
+		}
+		else
+		{
+			add(0, dy);
+			if (!isWalkable(x + 1, y))
+			{
+				add(1, dy);
+			}
+			if (!isWalkable(x - 1, y))
+			{
+				add(-1, dy);
+			}
+		}
+		return count;
+	}
+
+	bool JumpPointSearch::jump(int x, int y, int dx, int dy, int goalX, int goalY, int& jumpX, int& jumpY)
+	{
+		while (isWalkable(x, y))
+		{
+			if ((x == goalX && y == goalY) || hasForcedNeighbor(x, y, dx, dy))
+			{
+				jumpX = x;
+				jumpY = y;
+				return true;
+			}
+
+			// A diagonal step is a jump point whenever either of its straight components finds one
+			if (dx != 0 && dy != 0 &&
+				(jumpStraight(x + dx, y, dx, 0, goalX, goalY) || jumpStraight(x, y + dy, 0, dy, goalX, goalY)))
+			{
+				jumpX = x;
+				jumpY = y;
+				return true;
+			}
+
+			x += dx;
+			y += dy;
+		}
+		return false;
+	}
+
+	bool JumpPointSearch::jumpStraight(int x, int y, int dx, int dy, int goalX, int goalY)
+	{
+		while (isWalkable(x, y))
+		{
+			if ((x == goalX && y == goalY) || hasForcedNeighbor(x, y, dx, dy))
+			{
+				return true;
+			}
+			x += dx;
+			y += dy;
+		}
+		return false;
+	}
+
+	bool JumpPointSearch::hasForcedNeighbor(int x, int y, int dx, int dy)
+	{
+		if (dx != 0 && dy != 0)
+		{
+			return (isWalkable(x - dx, y + dy) && !isWalkable(x - dx, y)) ||
+				(isWalkable(x + dx, y - dy) && !isWalkable(x, y - dy));
+		}
+		if (dx != 0)
+		{
+			return (isWalkable(x + dx, y + 1) && !isWalkable(x, y + 1)) ||
+				(isWalkable(x + dx, y - 1) && !isWalkable(x, y - 1));
+		}
+		return (isWalkable(x + 1, y + dy) && !isWalkable(x + 1, y)) ||
+			(isWalkable(x - 1, y + dy) && !isWalkable(x - 1, y));
+	}
+
+	bool JumpPointSearch::isWalkable(int x, int y)
+	{
+		return Grid::inBounds(x, y) && !Grid::isBarrier(x, y);
+	}
+}
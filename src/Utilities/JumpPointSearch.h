@@ -0,0 +1,26 @@
+#pragma once
+#include "Grid.h"
+
+namespace VulkanProject
+{
+	// Jump Point Search successor generation for uniform-cost, 8-connected grids.
+	// Symmetric paths are pruned by jumping along straight and diagonal lines until a tile with a
+	// forced neighbor (or the goal) is found, so only those jump points ever reach the open list.
+	// Diagonal moves follow the same rules as Grid::neighbors, so path costs match plain A*.
+	class JumpPointSearch
+	{
+	public:
+		static const int MAX_SUCCESSORS = Grid::DIRECTION_COUNT;
+
+		// Writes the grid indices of the jump points reachable from (x, y) and returns how many were found.
+		// parentIndex is the grid index the search arrived from, or -1 at the start tile.
+		static int findSuccessors(int x, int y, int parentIndex, int goalX, int goalY, int successors[MAX_SUCCESSORS]);
+
+	private:
+		static int findNeighborDirections(int x, int y, int parentIndex, int directionX[MAX_SUCCESSORS], int directionY[MAX_SUCCESSORS]);
+		static bool jump(int x, int y, int dx, int dy, int goalX, int goalY, int& jumpX, int& jumpY);
+		static bool jumpStraight(int x, int y, int dx, int dy, int goalX, int goalY);
+		static bool hasForcedNeighbor(int x, int y, int dx, int dy);
+		static bool isWalkable(int x, int y);
+	};
+}
@@ -0,0 +1,383 @@
+#include "LandmarkHeuristic.h"
+#include "FlowField.h"
+#include "NodeTable.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace VulkanProject
+{
+	LandmarkHeuristic::LandmarkHeuristic()
+	{
+	}
+
+	LandmarkHeuristic::~LandmarkHeuristic()
+	{
+	}
+
+	LandmarkHeuristic* LandmarkHeuristic::getInstance()
+	{
+		static LandmarkHeuristic instance = LandmarkHeuristic();
+		return &instance;
+	}
+
+	void LandmarkHeuristic::build(int landmarkCount, unsigned int threadCount)
+	{
+		Grid::ensureLoaded();
+		width = Grid::getWidth();
+		height = Grid::getHeight();
+		gridVersion = Grid::getVersion();
+
+		selectLandmarks(std::clamp(landmarkCount, 1, MAX_LANDMARK_COUNT));
+		buildTables(threadCount);
+	}
+
+	bool LandmarkHeuristic::prepare(const std::string& path, int landmarkCount)
+	{
+		if (load(path) && getLandmarkCount() == std::clamp(landmarkCount, 1, MAX_LANDMARK_COUNT))
+		{
+			return true;
+		}
+		build(landmarkCount);
+		return save(path);
+	}
+
+	bool LandmarkHeuristic::save(const std::string& path) const
+	{
+		if (landmarks.empty())
+		{
+			std::cerr << "ERROR::No landmark tables to save!" << std::endl;
+			return false;
+		}
+
+		std::ofstream landmarkFile(path, std::ios::binary | std::ios::trunc);
+		if (!landmarkFile.is_open())
+		{
+			std::cerr << "ERROR::Unable to open file!" << std::endl;
+			return false;
+		}
+
+		Header header = Header();
+		memcpy(header.magic, "LMRK", 4);
+		header.formatVersion = FORMAT_VERSION;
+		header.width = (uint32_t)width;
+		header.height = (uint32_t)height;
+		header.landmarkCount = (uint32_t)landmarks.size();
+		header.gridHash = hashGrid();
+
+		landmarkFile.write((const char*)&header, sizeof(Header));
+		landmarkFile.write((const char*)landmarks.data(), (std::streamsize)(landmarks.size() * sizeof(int)));
+		landmarkFile.write((const char*)distances.data(), (std::streamsize)(distances.size() * sizeof(float)));
+		landmarkFile.close();
+		if (!landmarkFile)
+		{
+			std::cerr << "ERROR::Unable to write landmark file!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool LandmarkHeuristic::load(const std::string& path)
+	{
+		Grid::ensureLoaded();
+
+		std::ifstream landmarkFile(path, std::ios::binary);
+		if (!landmarkFile.is_open())
+		{
+			return false;
+		}
+
+		Header header = Header();
+		landmarkFile.read((char*)&header, sizeof(Header));
+		if (!landmarkFile || memcmp(header.magic, "LMRK", 4) != 0 || header.formatVersion != FORMAT_VERSION)
+		{
+			std::cerr << "ERROR::Unsupported landmark file!" << std::endl;
+			return false;
+		}
+
+		// Tables of another barrier layout would overestimate, so they are rejected rather than used
+		if ((int)header.width != Grid::getWidth() || (int)header.height != Grid::getHeight() || header.gridHash != hashGrid())
+		{
+			std::cerr << "ERROR::Landmark file does not match the grid!" << std::endl;
+			return false;
+		}
+
+		// The count sizes the reads below, so a corrupt one must not get that far
+		if (header.landmarkCount > (uint32_t)MAX_LANDMARK_COUNT)
+		{
+			std::cerr << "ERROR::Landmark file has too many landmarks!" << std::endl;
+			return false;
+		}
+
+		size_t nodeCount = (size_t)header.width * header.height;
+		std::vector<int> loadedLandmarks = std::vector<int>(header.landmarkCount);
+		std::vector<float> loadedDistances = std::vector<float>(nodeCount * header.landmarkCount);
+		landmarkFile.read((char*)loadedLandmarks.data(), (std::streamsize)(loadedLandmarks.size() * sizeof(int)));
+		landmarkFile.read((char*)loadedDistances.data(), (std::streamsize)(loadedDistances.size() * sizeof(float)));
+		if (!landmarkFile || header.landmarkCount == 0)
+		{
+			std::cerr << "ERROR::Landmark file is truncated!" << std::endl;
+			return false;
+		}
+
+		for (int landmark : loadedLandmarks)
+		{
+			if (landmark < 0 || (size_t)landmark >= nodeCount)
+			{
+				std::cerr << "ERROR::Landmark file is corrupt!" << std::endl;
+				return false;
+			}
+		}
+
+		width = (int)header.width;
+		height = (int)header.height;
+		gridVersion = Grid::getVersion();
+		landmarks = std::move(loadedLandmarks);
+		distances = std::move(loadedDistances);
+		return true;
+	}
+
+	void LandmarkHeuristic::ensurePrepared()
+	{
+		Grid::ensureLoaded();
+		if (checkedVersion.load(std::memory_order_acquire) == Grid::getVersion())
+		{
+			return;
+		}
+
+		// The first query after a grid change prepares the tables; the others wait here and then use them
+		std::lock_guard<std::mutex> lock(prepareMutex);
+		if (checkedVersion.load(std::memory_order_relaxed) == Grid::getVersion())
+		{
+			return;
+		}
+		std::vector<int> changedTiles = std::vector<int>();
+		if (landmarks.empty() || width != Grid::getWidth() || height != Grid::getHeight() ||
+			!Grid::getChangesSince(gridVersion, changedTiles))
+		{
+			prepare(DEFAULT_FILE);
+		}
+		checkedVersion.store(Grid::getVersion(), std::memory_order_release);
+	}
+
+	void LandmarkHeuristic::clear()
+	{
+		landmarks.clear();
+		distances.clear();
+	}
+
+	bool LandmarkHeuristic::isCurrent() const
+	{
+		return !landmarks.empty() && gridVersion == Grid::getVersion() && width == Grid::getWidth() && height == Grid::getHeight();
+	}
+
+	int LandmarkHeuristic::getLandmarkCount() const
+	{
+		return (int)landmarks.size();
+	}
+
+	int LandmarkHeuristic::getLandmark(int landmark) const
+	{
+		return landmarks[landmark];
+	}
+
+	double LandmarkHeuristic::estimate(int from, int to) const
+	{
+		// Costs are rounded to float, which may move each by 2^-24 of its value; shrinking every bound by
+		// twice that keeps it from overestimating
+		static constexpr double ROUNDING_SLACK = 1.0 / (1 << 23);
+
+		size_t landmarkCount = landmarks.size();
+		const float* fromCosts = &distances[(size_t)from * landmarkCount];
+		const float* toCosts = &distances[(size_t)to * landmarkCount];
+		double best = 0;
+		for (size_t landmark = 0; landmark < landmarkCount; landmark++)
+		{
+			double fromCost = fromCosts[landmark];
+			double toCost = toCosts[landmark];
+
+			// A landmark in another region says nothing about these tiles
+			if (fromCost == NodeTable::UNREACHED || toCost == NodeTable::UNREACHED)
+			{
+				continue;
+			}
+			best = std::max(best, std::abs(fromCost - toCost) - (fromCost + toCost) * ROUNDING_SLACK);
+		}
+		return best;
+	}
+
+	void LandmarkHeuristic::selectLandmarks(int landmarkCount)
+	{
+		landmarks.clear();
+		int seed = findSeed();
+		if (seed < 0)
+		{
+			return;
+		}
+
+		// Each landmark is the tile farthest from everything picked so far. The seed only anchors the first
+		// pick, which keeps landmarks on the edges of the map, where they give the tightest bounds.
+		int nodeCount = width * height;
+		std::vector<double> nearest = std::vector<double>(nodeCount, NodeTable::UNREACHED);
+		IndexedHeap openNodes = IndexedHeap();
+		openNodes.resize(nodeCount);
+		growNearest(seed, nearest, openNodes);
+
+		while ((int)landmarks.size() < landmarkCount)
+		{
+			int farthest = -1;
+			for (int node = 0; node < nodeCount; node++)
+			{
+				if (nearest[node] != NodeTable::UNREACHED && (farthest < 0 || nearest[node] > nearest[farthest]))
+				{
+					farthest = node;
+				}
+			}
+
+			// Fewer reachable tiles than landmarks asked for
+			if (nearest[farthest] == 0)
+			{
+				break;
+			}
+			landmarks.push_back(farthest);
+			growNearest(farthest, nearest, openNodes);
+		}
+	}
+
+	void LandmarkHeuristic::growNearest(int landmark, std::vector<double>& nearest, IndexedHeap& openNodes) const
+	{
+		// Dijkstra that stops wherever an earlier landmark is already closer, so later picks only
+		// search their own neighbourhood
+		nearest[landmark] = 0;
+		openNodes.push(landmark, 0);
+		while (!openNodes.empty())
+		{
+			int current = openNodes.pop();
+			int currentX = current % width;
+			int currentY = current / width;
+			for (int direction = 0; direction < Grid::DIRECTION_COUNT; direction++)
+			{
+				int neighborX = currentX + Grid::DIRECTION_X[direction];
+				int neighborY = currentY + Grid::DIRECTION_Y[direction];
+				if (!Grid::inBounds(neighborX, neighborY) || Grid::isBarrier(neighborX, neighborY))
+				{
+					continue;
+				}
+
+				int neighbor = Grid::indexOf(neighborX, neighborY);
+				double distance = nearest[current] + (direction < 4 ? 1.0 : sqrt(2.0));
+				if (distance >= nearest[neighbor])
+				{
+					continue;
+				}
+
+				if (openNodes.contains(neighbor))
+				{
+					openNodes.decreaseKey(neighbor, distance);
+				}
+				else
+				{
+					openNodes.push(neighbor, distance);
+				}
+				nearest[neighbor] = distance;
+			}
+		}
+	}
+
+	void LandmarkHeuristic::buildTables(unsigned int threadCount)
+	{
+		size_t landmarkCount = landmarks.size();
+		distances.assign((size_t)width * height * landmarkCount, (float)NodeTable::UNREACHED);
+		if (landmarkCount == 0)
+		{
+			return;
+		}
+
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threadCount = (unsigned int)std::min<size_t>(threadCount, landmarkCount);
+
+		// Costs are symmetric, so the flow field towards a landmark holds the cost from it to every tile
+		std::atomic<size_t> nextLandmark = 0;
+		auto worker = [&]()
+		{
+			FlowField field = FlowField();
+			for (size_t landmark = nextLandmark++; landmark < landmarkCount; landmark = nextLandmark++)
+			{
+				int position[2] = { landmarks[landmark] % width, landmarks[landmark] / width };
+				field.build(position);
+
+				float* column = &distances[landmark];
+				for (int y = 0; y < height; y++)
+				{
+					for (int x = 0; x < width; x++)
+					{
+						column[((size_t)y * width + x) * landmarkCount] = (float)field.getDistance(x, y);
+					}
+				}
+			}
+		};
+
+		std::vector<std::thread> workers = std::vector<std::thread>();
+		for (unsigned int i = 1; i < threadCount; i++)
+		{
+			workers.emplace_back(worker);
+		}
+		worker();
+
+		for (std::thread& thread : workers)
+		{
+			thread.join();
+		}
+	}
+
+	int LandmarkHeuristic::findSeed()
+	{
+		// The open tile closest to the centre of the map
+		int seed = -1;
+		double seedDistance = 0;
+		for (int y = 0; y < Grid::getHeight(); y++)
+		{
+			for (int x = 0; x < Grid::getWidth(); x++)
+			{
+				double dx = x - Grid::getWidth() / 2.0;
+				double dy = y - Grid::getHeight() / 2.0;
+				double distance = dx * dx + dy * dy;
+				if (!Grid::isBarrier(x, y) && (seed < 0 || distance < seedDistance))
+				{
+					seed = Grid::indexOf(x, y);
+					seedDistance = distance;
+				}
+			}
+		}
+		return seed;
+	}
+
+	uint64_t LandmarkHeuristic::hashGrid()
+	{
+		// FNV-1a over the barrier bits, ignoring the padding past the end of each row
+		uint64_t hash = 14695981039346656037ull;
+		int rowWords = Grid::getRowWords();
+		int tailBits = Grid::getWidth() % 64;
+		for (int y = 0; y < Grid::getHeight(); y++)
+		{
+			for (int word = 0; word < rowWords; word++)
+			{
+				uint64_t value = Grid::getBarrierWord(y, word);
+				if (word == rowWords - 1 && tailBits != 0)
+				{
+					value &= (1ull << tailBits) - 1;
+				}
+				for (int byte = 0; byte < 8; byte++)
+				{
+					hash ^= (value >> (byte * 8)) & 0xFF;
+					hash *= 1099511628211ull;
+				}
+			}
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace VulkanProject
+{
+	// ALT heuristic: exact path costs from a handful of landmarks to every tile. By the triangle inequality
+	// |d(L, goal) - d(L, n)| never exceeds the cost from n to the goal, so the largest such difference over all
+	// landmarks is an admissible estimate that, unlike the straight line, accounts for walls in between.
+	// The tables describe the grid they were built for; any edit makes them stale until they are rebuilt.
+	// Building or loading is not thread-safe, but any number of searches may read the tables at once; ensurePrepared
+	// is the one entry point searches may call concurrently.
+	class LandmarkHeuristic
+	{
+	public:
+		LandmarkHeuristic();
+		~LandmarkHeuristic();
+		// Shared tables used by SearchContext's LANDMARKS mode
+		static LandmarkHeuristic* getInstance();
+
+		// Picks 'landmarkCount' landmarks by farthest-point selection, then fills their tables on up to
+		// 'threadCount' threads (0 uses every hardware thread)
+		void build(int landmarkCount = DEFAULT_LANDMARK_COUNT, unsigned int threadCount = 0);
+		// Loads tables saved for exactly the current barrier layout, otherwise builds them and saves the result.
+		// Meant to be called right after the grid is loaded.
+		bool prepare(const std::string& path, int landmarkCount = DEFAULT_LANDMARK_COUNT);
+		bool save(const std::string& path) const;
+		// Fails when the file was written for a different barrier layout or more than MAX_LANDMARK_COUNT landmarks
+		bool load(const std::string& path);
+		// Called by every LANDMARKS query: prepares DEFAULT_FILE, under a lock and once per grid version, when there
+		// are no tables or they were made for another grid. Tables only made stale by edits are left alone, since
+		// rebuilding after every edit would cost more than it saves; those queries fall back to plain A*.
+		void ensurePrepared();
+		void clear();
+		// True when tables exist and the grid has not been edited since they were built or loaded
+		bool isCurrent() const;
+		int getLandmarkCount() const;
+		// Grid index of a landmark
+		int getLandmark(int landmark) const;
+		// Lower bound on the cost of moving between two grid indices
+		double estimate(int from, int to) const;
+
+		static const int DEFAULT_LANDMARK_COUNT = 8;
+		// build() picks at most this many, and load() rejects files with more
+		static constexpr int MAX_LANDMARK_COUNT = 32;
+		static constexpr const char* DEFAULT_FILE = "./Barriers.landmarks";
+		static const uint32_t FORMAT_VERSION = 1;
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t formatVersion;
+			uint32_t width;
+			uint32_t height;
+			uint32_t landmarkCount;
+			uint32_t reserved;
+			uint64_t gridHash;
+		};
+
+		void selectLandmarks(int landmarkCount);
+		void growNearest(int landmark, std::vector<double>& nearest, IndexedHeap& openNodes) const;
+		void buildTables(unsigned int threadCount);
+		static int findSeed();
+		static uint64_t hashGrid();
+
+		int width = 0;
+		int height = 0;
+		uint64_t gridVersion = 0;
+		std::vector<int> landmarks;
+		// Costs are stored tile by tile, all landmarks of one tile next to each other, so an estimate
+		// touches a single cache line per tile. Unreachable tiles hold infinity.
+		std::vector<float> distances;
+		std::mutex prepareMutex;
+		// Grid version ensurePrepared last looked at
+		std::atomic<uint64_t> checkedVersion = 0;
+	};
+}
@@ -0,0 +1,117 @@
+#include "LineOfSight.h"
+
+namespace VulkanProject
+{
+	template <typename Visit>
+	bool LineOfSight::walkRows(int fromX, int fromY, int toX, int toY, Visit visitRow)
+	{
+		// Walk rows from top to bottom
+		if (fromY > toY)
+		{
+			std::swap(fromX, toX);
+			std::swap(fromY, toY);
+		}
+
+		if (fromY == toY)
+		{
+			return visitRow(fromY, std::min(fromX, toX), std::max(fromX, toX));
+		}
+
+		// Work in doubled coordinates so tile centers (x + 0.5) and row edges are both integers.
+		// In row y the segment spans the X range between its crossings of Y = 2y and Y = 2y + 2 (clamped
+		// to the end points); the tiles whose interiors it touches run from floor(lo / 2) to ceil(hi / 2) - 1.
+		int64_t startX = 2 * (int64_t)fromX + 1;
+		int64_t startY = 2 * (int64_t)fromY + 1;
+		int64_t deltaX = 2 * (int64_t)(toX - fromX);
+		int64_t deltaY = 2 * (int64_t)(toY - fromY);
+		int64_t endY = startY + deltaY;
+
+		for (int y = fromY; y <= toY; y++)
+		{
+			int64_t topY = std::max<int64_t>(2 * (int64_t)y, startY);
+			int64_t bottomY = std::min<int64_t>(2 * (int64_t)y + 2, endY);
+
+			// X * (2 * deltaY) at both crossings; positive because the segment stays inside the grid
+			int64_t topX = startX * deltaY + (topY - startY) * deltaX;
+			int64_t bottomX = startX * deltaY + (bottomY - startY) * deltaX;
+			int64_t lo = std::min(topX, bottomX);
+			int64_t hi = std::max(topX, bottomX);
+
+			int64_t denominator = 2 * deltaY;
+			int firstX = (int)(lo / denominator);
+			int lastX = (int)((hi + denominator - 1) / denominator) - 1;
+			if (lastX < firstX)
+			{
+				lastX = firstX;
+			}
+
+			if (!visitRow(y, firstX, lastX))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool LineOfSight::isVisible(int fromX, int fromY, int toX, int toY)
+	{
+		if (!Grid::inBounds(fromX, fromY) || !Grid::inBounds(toX, toY))
+		{
+			return false;
+		}
+		return walkRows(fromX, fromY, toX, toY, isRowClear);
+	}
+
+	void LineOfSight::getCoveredTiles(int fromX, int fromY, int toX, int toY, std::vector<int>& tiles)
+	{
+		if (!Grid::inBounds(fromX, fromY) || !Grid::inBounds(toX, toY))
+		{
+			return;
+		}
+		walkRows(fromX, fromY, toX, toY, [&tiles](int y, int firstX, int lastX)
+		{
+			for (int x = firstX; x <= lastX; x++)
+			{
+				tiles.push_back(Grid::indexOf(x, y));
+			}
+			return true;
+		});
+	}
+
+	void LineOfSight::isVisible(std::span<const PathQuery> lines, std::span<uint8_t> visible)
+	{
+		if (visible.size() < lines.size())
+		{
+			throw std::runtime_error("Not enough room for visibility results!");
+		}
+
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			visible[i] = isVisible(lines[i].start[0], lines[i].start[1], lines[i].goal[0], lines[i].goal[1]) ? 1 : 0;
+		}
+	}
+
+	bool LineOfSight::isRowClear(int y, int firstX, int lastX)
+	{
+		// Test the whole run of tiles a 64-bit word at a time
+		int firstWord = firstX / 64;
+		int lastWord = lastX / 64;
+		for (int word = firstWord; word <= lastWord; word++)
+		{
+			uint64_t mask = ~uint64_t(0);
+			if (word == firstWord)
+			{
+				mask &= ~uint64_t(0) << (firstX % 64);
+			}
+			if (word == lastWord)
+			{
+				mask &= ~uint64_t(0) >> (63 - lastX % 64);
+			}
+			if (Grid::getBarrierWord(y, word) & mask)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Grid.h"
+#include "SearchContext.h"
+#include <span>
+
+namespace VulkanProject
+{
+	// Visibility between tile centers over the grid's bit-packed barrier rows.
+	// A line is blocked when it passes through the interior of a barrier tile; grazing a corner is allowed,
+	// which matches the diagonal moves permitted by Grid::neighbors.
+	class LineOfSight
+	{
+	public:
+		static bool isVisible(int fromX, int fromY, int toX, int toY);
+		// Tests every line from start to goal; visible[i] is set to 1 when queries[i] is unobstructed
+		static void isVisible(std::span<const PathQuery> lines, std::span<uint8_t> visible);
+		// Appends the grid index of every tile whose interior the line passes through, i.e. the tiles isVisible tests
+		static void getCoveredTiles(int fromX, int fromY, int toX, int toY, std::vector<int>& tiles);
+
+	private:
+		// Calls visitRow(y, firstX, lastX) for each row the line crosses, stopping early when it returns false
+		template <typename Visit>
+		static bool walkRows(int fromX, int fromY, int toX, int toY, Visit visitRow);
+		static bool isRowClear(int y, int firstX, int lastX);
+	};
+}
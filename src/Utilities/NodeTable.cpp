@@ -0,0 +1,121 @@
+#include "NodeTable.h"
+
+namespace VulkanProject
+{
+	NodeTable::NodeTable()
+	{
+	}
+
+	NodeTable::~NodeTable()
+	{
+	}
+
+	void NodeTable::beginQuery(int nodeCount, bool sparse)
+	{
+		this->sparse = sparse;
+		if (sparse)
+		{
+			// Dropping the dense table is what makes the sparse one worth having
+			if (!records.empty())
+			{
+				records = std::vector<NodeRecord>();
+			}
+			sparseRecords.clear();
+			generation = 1;
+			return;
+		}
+		if (!sparseRecords.empty())
+		{
+			sparseRecords = std::unordered_map<int, NodeRecord>();
+		}
+
+		if ((int)records.size() != nodeCount)
+		{
+			records.assign(nodeCount, NodeRecord{ UNREACHED, NO_PARENT, 0, NodeState::UNSEEN });
+			generation = 0;
+			allocationCount++;
+			allocatedBytes += nodeCount * sizeof(NodeRecord);
+		}
+
+		generation++;
+
+		// Once the counter wraps, old stamps could alias the new generation, so wipe them just this once
+		if (generation == 0)
+		{
+			for (NodeRecord& record : records)
+			{
+				record.generation = 0;
+			}
+			generation = 1;
+		}
+	}
+
+	bool NodeTable::isSeen(int node) const
+	{
+		return find(node) != nullptr;
+	}
+
+	NodeTable::NodeState NodeTable::getState(int node) const
+	{
+		const NodeRecord* record = find(node);
+		return record != nullptr ? record->state : NodeState::UNSEEN;
+	}
+
+	double NodeTable::getG(int node) const
+	{
+		const NodeRecord* record = find(node);
+		return record != nullptr ? record->g : UNREACHED;
+	}
+
+	int NodeTable::getParent(int node) const
+	{
+		const NodeRecord* record = find(node);
+		return record != nullptr ? record->parent : NO_PARENT;
+	}
+
+	void NodeTable::open(int node, double g, int parent)
+	{
+		NodeRecord& record = recordOf(node);
+		record.g = g;
+		record.parent = parent;
+		record.generation = generation;
+		record.state = NodeState::OPEN;
+	}
+
+	void NodeTable::close(int node)
+	{
+		recordOf(node).state = NodeState::CLOSED;
+	}
+
+	void NodeTable::reparent(int node, double g, int parent)
+	{
+		NodeRecord& record = recordOf(node);
+		record.g = g;
+		record.parent = parent;
+	}
+
+	size_t NodeTable::getAllocationCount() const
+	{
+		return allocationCount;
+	}
+
+	size_t NodeTable::getAllocatedBytes() const
+	{
+		return allocatedBytes;
+	}
+
+	const NodeTable::NodeRecord* NodeTable::find(int node) const
+	{
+		if (!sparse)
+		{
+			return records[node].generation == generation ? &records[node] : nullptr;
+		}
+		auto record = sparseRecords.find(node);
+		return record != sparseRecords.end() ? &record->second : nullptr;
+	}
+
+	NodeTable::NodeRecord& NodeTable::recordOf(int node)
+	{
+		return sparse ? sparseRecords[node] : records[node];
+	}
+}
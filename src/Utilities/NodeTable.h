@@ -0,0 +1,60 @@
+#pragma once
+#include "../Core/stdafx.h"
+#include <limits>
+#include <unordered_map>
+
+namespace VulkanProject
+{
+	// Per-tile search bookkeeping (g-value, parent, open/closed) sized to the grid and reused between queries.
+	// Every record carries the generation of the query that last wrote it, so starting a new query only
+	// bumps the generation instead of clearing or reallocating the table.
+	// A sparse table keeps records only for the nodes a query touched, in a hash map emptied by every query, so
+	// searching a paged grid costs memory in proportion to the search rather than to the grid.
+	class NodeTable
+	{
+	public:
+		enum class NodeState : uint8_t
+		{
+			UNSEEN,
+			OPEN,
+			CLOSED
+		};
+
+		static constexpr double UNREACHED = std::numeric_limits<double>::infinity();
+		static constexpr int NO_PARENT = -1;
+
+		NodeTable();
+		~NodeTable();
+		void beginQuery(int nodeCount, bool sparse = false);
+		bool isSeen(int node) const;
+		NodeState getState(int node) const;
+		double getG(int node) const;
+		int getParent(int node) const;
+		void open(int node, double g, int parent);
+		void close(int node);
+		// Replaces the g-value and parent of a node without changing its open/closed state
+		void reparent(int node, double g, int parent);
+		size_t getAllocationCount() const;
+		size_t getAllocatedBytes() const;
+
+	private:
+		struct NodeRecord
+		{
+			double g;
+			int parent;
+			uint32_t generation;
+			NodeState state;
+		};
+
+		// Null when the node has no record from this query
+		const NodeRecord* find(int node) const;
+		NodeRecord& recordOf(int node);
+
+		std::vector<NodeRecord> records;
+		std::unordered_map<int, NodeRecord> sparseRecords;
+		bool sparse = false;
+		uint32_t generation = 0;
+		size_t allocationCount = 0;
+		size_t allocatedBytes = 0;
+	};
+}
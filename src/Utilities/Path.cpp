@@ -6,13 +6,11 @@ namespace VulkanProject
     {
     }
 
-    Path::Path(int start[2], int goal[2])
+    Path::Path(const int start[2], const int goal[2])
     {
         startNode = Tile(start[0], start[1], false);
         goalNode = Tile(goal[0], goal[1], false);
 
-        startNode.setParent(new Tile(startNode));
-
         addTile(startNode);
     }
 
@@ -59,7 +57,7 @@ namespace VulkanProject
 
     void Path::setSequence(std::vector<Tile> tileSequence)
     {
-        this->tileSequence = tileSequence;
+        this->tileSequence = std::move(tileSequence);
     }
 
     std::vector<Tile> Path::getSequence() const
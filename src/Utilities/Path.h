@@ -7,7 +7,7 @@ namespace VulkanProject
 	class Path {
 	public:
 		Path();
-		Path(int start[2], int goal[2]);
+		Path(const int start[2], const int goal[2]);
 		~Path();
 		void addTile(Tile tile);
 		bool removeTile(Tile tile);
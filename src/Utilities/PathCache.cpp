@@ -0,0 +1,263 @@
+#include "PathCache.h"
+#include "LineOfSight.h"
+
+namespace VulkanProject
+{
+	PathCache::PathCache(size_t memoryBudget)
+	{
+		this->memoryBudget = memoryBudget;
+	}
+
+	PathCache::~PathCache()
+	{
+	}
+
+	Path PathCache::generatePath(SearchContext& context, const int start[2], const int goal[2], SearchContext::SEARCH_MODE mode,
+		SearchStats* stats, bool* hit)
+	{
+		Key key = { start[0], start[1], goal[0], goal[1], mode };
+		uint64_t searchVersion;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			synchronize();
+
+			std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator found = lookup.find(key);
+			if (found != lookup.end())
+			{
+				hitCount++;
+				entries.splice(entries.begin(), entries, found->second);
+				if (stats != nullptr)
+				{
+					*stats = SearchStats();
+				}
+				if (hit != nullptr)
+				{
+					*hit = true;
+				}
+				return found->second->path;
+			}
+			missCount++;
+			searchVersion = gridVersion;
+		}
+		if (hit != nullptr)
+		{
+			*hit = false;
+		}
+
+		// Search without holding the lock so other threads keep getting hits meanwhile
+		Path path = context.generatePath(start, goal, mode, stats);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		synchronize();
+		// A result computed against an older grid is returned but not kept
+		if (gridVersion == searchVersion && lookup.find(key) == lookup.end())
+		{
+			insert(key, path);
+		}
+		return path;
+	}
+
+	void PathCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		lookup.clear();
+		tileEntries.clear();
+		memoryUsage = 0;
+	}
+
+	void PathCache::setMemoryBudget(size_t memoryBudget)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->memoryBudget = memoryBudget;
+		evictToBudget();
+	}
+
+	size_t PathCache::getMemoryBudget() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return memoryBudget;
+	}
+
+	size_t PathCache::getMemoryUsage() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return memoryUsage;
+	}
+
+	size_t PathCache::getEntryCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries.size();
+	}
+
+	size_t PathCache::getHitCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return hitCount;
+	}
+
+	size_t PathCache::getMissCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return missCount;
+	}
+
+	size_t PathCache::getEvictionCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return evictionCount;
+	}
+
+	size_t PathCache::getInvalidationCount() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return invalidationCount;
+	}
+
+	bool PathCache::Key::operator==(const Key& other) const
+	{
+		return startX == other.startX && startY == other.startY &&
+			goalX == other.goalX && goalY == other.goalY && mode == other.mode;
+	}
+
+	size_t PathCache::KeyHash::operator()(const Key& key) const
+	{
+		uint64_t hash = (uint64_t)(uint32_t)key.startX;
+		hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)key.startY;
+		hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)key.goalX;
+		hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)key.goalY;
+		hash = hash * 0x9E3779B97F4A7C15ull + (uint32_t)key.mode;
+		return (size_t)(hash ^ (hash >> 29));
+	}
+
+	void PathCache::synchronize()
+	{
+		Grid::ensureLoaded();
+		uint64_t version = Grid::getVersion();
+		if (version == gridVersion)
+		{
+			return;
+		}
+
+		changedTiles.clear();
+		if (!Grid::getChangesSince(gridVersion, changedTiles))
+		{
+			// A different grid was loaded; nothing cached describes it
+			invalidationCount += entries.size();
+			entries.clear();
+			lookup.clear();
+			tileEntries.clear();
+			memoryUsage = 0;
+		}
+		else
+		{
+			invalidateTile(ANY_TILE);
+			for (int tile : changedTiles)
+			{
+				invalidateTile(tile);
+			}
+		}
+		gridVersion = version;
+	}
+
+	void PathCache::insert(const Key& key, const Path& path)
+	{
+		entries.push_front({ key, path, std::vector<int>(), 0 });
+		Entry& entry = entries.front();
+		findCoveredTiles(key, path, entry.tiles);
+
+		// Rough footprint: the entry and its path, plus a map slot per lookup and tile listing
+		entry.bytes = sizeof(Entry) + path.getSequence().size() * sizeof(Tile) +
+			entry.tiles.size() * (sizeof(int) + sizeof(Entry*)) + sizeof(Key) + 4 * sizeof(void*);
+		for (int tile : entry.tiles)
+		{
+			tileEntries[tile].push_back(&entry);
+		}
+		lookup[key] = entries.begin();
+		memoryUsage += entry.bytes;
+
+		evictToBudget();
+	}
+
+	void PathCache::erase(std::list<Entry>::iterator entry)
+	{
+		for (int tile : entry->tiles)
+		{
+			std::unordered_map<int, std::vector<Entry*>>::iterator listed = tileEntries.find(tile);
+			std::vector<Entry*>& tileList = listed->second;
+			std::vector<Entry*>::iterator position = std::find(tileList.begin(), tileList.end(), &*entry);
+			*position = tileList.back();
+			tileList.pop_back();
+			if (tileList.empty())
+			{
+				tileEntries.erase(listed);
+			}
+		}
+
+		memoryUsage -= entry->bytes;
+		lookup.erase(entry->key);
+		entries.erase(entry);
+	}
+
+	void PathCache::invalidateTile(int tile)
+	{
+		std::unordered_map<int, std::vector<Entry*>>::iterator listed = tileEntries.find(tile);
+		if (listed == tileEntries.end())
+		{
+			return;
+		}
+
+		// erase() edits this tile's list, so work from a copy
+		std::vector<Entry*> touched = listed->second;
+		for (Entry* entry : touched)
+		{
+			erase(lookup.at(entry->key));
+			invalidationCount++;
+		}
+	}
+
+	void PathCache::evictToBudget()
+	{
+		while (memoryUsage > memoryBudget && !entries.empty())
+		{
+			erase(std::prev(entries.end()));
+			evictionCount++;
+		}
+	}
+
+	void PathCache::findCoveredTiles(const Key& key, const Path& path, std::vector<int>& tiles)
+	{
+		std::vector<Tile> sequence = path.getSequence();
+
+		// A failed search leaves just the start tile behind
+		bool found = (key.startX == key.goalX && key.startY == key.goalY) ||
+			(!sequence.empty() && sequence.back().getX() == key.goalX && sequence.back().getY() == key.goalY);
+		if (!found || !Grid::inBounds(key.startX, key.startY))
+		{
+			tiles.push_back(ANY_TILE);
+			return;
+		}
+
+		// Sequences leave out the start tile; any-angle steps may jump several tiles along a straight line
+		tiles.push_back(Grid::indexOf(key.startX, key.startY));
+		int previousX = key.startX;
+		int previousY = key.startY;
+		for (const Tile& tile : sequence)
+		{
+			if (abs(tile.getX() - previousX) <= 1 && abs(tile.getY() - previousY) <= 1)
+			{
+				tiles.push_back(Grid::indexOf(tile.getX(), tile.getY()));
+			}
+			else
+			{
+				LineOfSight::getCoveredTiles(previousX, previousY, tile.getX(), tile.getY(), tiles);
+			}
+			previousX = tile.getX();
+			previousY = tile.getY();
+		}
+
+		std::sort(tiles.begin(), tiles.end());
+		tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "SearchContext.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace VulkanProject
+{
+	// Bounded, thread-safe LRU cache for queries that repeat; Search::generatePath and generatePaths go through
+	// a shared one (Search::getPathCache).
+	// Entries are valid for the grid version they were synchronised to. Before every lookup the cache pulls
+	// the edits made since then from Grid::getChangesSince and drops exactly the entries whose path covers an
+	// edited tile (start, every step, and for any-angle paths every tile under each straight segment).
+	// Cached "no path" results are dropped on any edit, and loading a new grid clears everything.
+	// An edit that removes a barrier away from a cached path leaves that path valid, even if a shorter route
+	// now exists.
+	class PathCache
+	{
+	public:
+		PathCache(size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+		~PathCache();
+		// Answers from the cache, or searches with 'context' and keeps the result. 'stats' is filled as in
+		// SearchContext::generatePath on a miss and left empty on a hit; 'hit', when given, says which it was.
+		Path generatePath(SearchContext& context, const int start[2], const int goal[2],
+			SearchContext::SEARCH_MODE mode = SearchContext::SEARCH_MODE::A_STAR, SearchStats* stats = nullptr, bool* hit = nullptr);
+		void clear();
+		// Approximate bytes the entries may use; least recently used entries are evicted beyond it
+		void setMemoryBudget(size_t memoryBudget);
+		size_t getMemoryBudget() const;
+		size_t getMemoryUsage() const;
+		size_t getEntryCount() const;
+		size_t getHitCount() const;
+		size_t getMissCount() const;
+		// Entries removed to stay within the memory budget
+		size_t getEvictionCount() const;
+		// Entries removed because a grid edit touched their path
+		size_t getInvalidationCount() const;
+
+		static const size_t DEFAULT_MEMORY_BUDGET = 16 << 20;
+
+	private:
+		struct Key
+		{
+			int startX;
+			int startY;
+			int goalX;
+			int goalY;
+			SearchContext::SEARCH_MODE mode;
+
+			bool operator==(const Key& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			Key key;
+			Path path;
+			// Grid indices this entry is listed under in 'tileEntries'
+			std::vector<int> tiles;
+			size_t bytes;
+		};
+
+		// Tile key for unreachable results, which any edit may change
+		static constexpr int ANY_TILE = -1;
+
+		void synchronize();
+		void insert(const Key& key, const Path& path);
+		void erase(std::list<Entry>::iterator entry);
+		void invalidateTile(int tile);
+		void evictToBudget();
+		static void findCoveredTiles(const Key& key, const Path& path, std::vector<int>& tiles);
+
+		mutable std::mutex mutex;
+		// Most recently used first
+		std::list<Entry> entries;
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> lookup;
+		std::unordered_map<int, std::vector<Entry*>> tileEntries;
+		uint64_t gridVersion = 0;
+		std::vector<int> changedTiles;
+		size_t memoryBudget;
+		size_t memoryUsage = 0;
+		size_t hitCount = 0;
+		size_t missCount = 0;
+		size_t evictionCount = 0;
+		size_t invalidationCount = 0;
+	};
+}
@@ -0,0 +1,71 @@
+#include "PathRequest.h"
+
+namespace VulkanProject
+{
+	PathRequest::PathRequest(const int start[2], const int goal[2])
+	{
+		this->start[0] = start[0];
+		this->start[1] = start[1];
+		this->goal[0] = goal[0];
+		this->goal[1] = goal[1];
+		path = Path(start, goal);
+	}
+
+	PathRequest::~PathRequest()
+	{
+	}
+
+	PathRequest::STATUS PathRequest::getStatus() const
+	{
+		return status;
+	}
+
+	bool PathRequest::isDone() const
+	{
+		STATUS current = status;
+		return current == STATUS::FOUND || current == STATUS::NOT_FOUND || current == STATUS::CANCELLED;
+	}
+
+	void PathRequest::cancel()
+	{
+		// Only a request still in flight can be cancelled; a finished result stays as it is
+		STATUS expected = STATUS::QUEUED;
+		if (!status.compare_exchange_strong(expected, STATUS::CANCELLED))
+		{
+			expected = STATUS::SEARCHING;
+			status.compare_exchange_strong(expected, STATUS::CANCELLED);
+		}
+	}
+
+	Path PathRequest::getPath() const
+	{
+		return path;
+	}
+
+	const int* PathRequest::getStart() const
+	{
+		return start;
+	}
+
+	const int* PathRequest::getGoal() const
+	{
+		return goal;
+	}
+
+	size_t PathRequest::getExpansionCount() const
+	{
+		return expansionCount;
+	}
+
+	void PathRequest::update(STATUS status, Path path, size_t expansions)
+	{
+		this->path = std::move(path);
+		expansionCount += expansions;
+
+		// A cancel that raced with this update wins
+		STATUS current = this->status;
+		while (current != STATUS::CANCELLED && !this->status.compare_exchange_weak(current, status))
+		{
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Path.h"
+#include <atomic>
+
+namespace VulkanProject
+{
+	// Handle to a path query queued on PathScheduler. The scheduler fills it in over one or more frames;
+	// until then getPath() returns the best partial path found so far. Status and cancel() may be used from
+	// any thread, getPath() only from the thread that calls PathScheduler::update().
+	class PathRequest
+	{
+	public:
+		enum class STATUS
+		{
+			QUEUED,
+			SEARCHING,
+			FOUND,
+			NOT_FOUND,
+			CANCELLED
+		};
+
+		PathRequest(const int start[2], const int goal[2]);
+		~PathRequest();
+		STATUS getStatus() const;
+		// True once the request found a path, failed or was cancelled
+		bool isDone() const;
+		// The scheduler drops the request on its next update; the last partial path stays available
+		void cancel();
+		// The path to the goal once found, otherwise the partial path towards the tile closest to the goal
+		Path getPath() const;
+		const int* getStart() const;
+		const int* getGoal() const;
+		// Expansions spent on this request, over every frame it was worked on
+		size_t getExpansionCount() const;
+
+	private:
+		friend class PathScheduler;
+
+		void update(STATUS status, Path path, size_t expansions);
+
+		int start[2];
+		int goal[2];
+		std::atomic<STATUS> status = STATUS::QUEUED;
+		Path path;
+		size_t expansionCount = 0;
+	};
+}
@@ -0,0 +1,77 @@
+#include "PathScheduler.h"
+
+namespace VulkanProject
+{
+	PathScheduler::PathScheduler()
+	{
+	}
+
+	PathScheduler::~PathScheduler()
+	{
+	}
+
+	PathScheduler* PathScheduler::getInstance()
+	{
+		static PathScheduler instance = PathScheduler();
+		return &instance;
+	}
+
+	std::shared_ptr<PathRequest> PathScheduler::submit(const int start[2], const int goal[2])
+	{
+		std::shared_ptr<PathRequest> request = std::make_shared<PathRequest>(start, goal);
+		requests.push_back(request);
+		return request;
+	}
+
+	void PathScheduler::update(size_t expansionBudget)
+	{
+		while (expansionBudget > 0 && !requests.empty())
+		{
+			PathRequest& request = *requests.front();
+			if (request.getStatus() == PathRequest::STATUS::CANCELLED)
+			{
+				requests.pop_front();
+				searching = false;
+				continue;
+			}
+
+			// Node tables from before an edit no longer describe the grid
+			if (!searching || searchVersion != Grid::getVersion())
+			{
+				search.begin(request.getStart(), request.getGoal());
+				searching = true;
+				searchVersion = Grid::getVersion();
+			}
+
+			size_t expansionsBefore = search.getExpansionCount();
+			SearchContext::AStar::SEARCH_STATE state = search.step(expansionBudget);
+			size_t expansions = search.getExpansionCount() - expansionsBefore;
+			expansionBudget -= std::min(expansions, expansionBudget);
+
+			if (state == SearchContext::AStar::SEARCH_STATE::SEARCHING)
+			{
+				request.update(PathRequest::STATUS::SEARCHING, search.getPath(), expansions);
+				continue;
+			}
+
+			if (state == SearchContext::AStar::SEARCH_STATE::FOUND)
+			{
+				LOG("Path Found.");
+			}
+			else
+			{
+				LOG("No Path Found.");
+			}
+			request.update(state == SearchContext::AStar::SEARCH_STATE::FOUND ? PathRequest::STATUS::FOUND : PathRequest::STATUS::NOT_FOUND,
+				search.getPath(), expansions);
+			requests.pop_front();
+			searching = false;
+		}
+	}
+
+	size_t PathScheduler::getPendingCount() const
+	{
+		return std::count_if(requests.begin(), requests.end(),
+			[](const std::shared_ptr<PathRequest>& request) { return !request->isDone(); });
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "PathRequest.h"
+#include "SearchContext.h"
+#include <deque>
+#include <memory>
+
+namespace VulkanProject
+{
+	// Runs path queries a slice at a time so that searching never stalls a frame: each update() spends a fixed
+	// number of A* expansions on the queue, oldest request first, and resumes where it stopped on the next call.
+	// A request whose grid is edited while it is being searched starts over on the new grid.
+	// submit() and update() belong to one thread, normally the one running the frame loop.
+	class PathScheduler
+	{
+	public:
+		PathScheduler();
+		~PathScheduler();
+		// Shared scheduler driven by main's frame loop
+		static PathScheduler* getInstance();
+		std::shared_ptr<PathRequest> submit(const int start[2], const int goal[2]);
+		// Spends at most 'expansionBudget' expansions, possibly finishing several requests
+		void update(size_t expansionBudget = DEFAULT_FRAME_BUDGET);
+		// Requests not yet finished or cancelled
+		size_t getPendingCount() const;
+
+		// Roughly a millisecond of A* on a typical map
+		static const size_t DEFAULT_FRAME_BUDGET = 4096;
+
+	private:
+		std::deque<std::shared_ptr<PathRequest>> requests;
+		// Search state of the request at the front of the queue, kept between updates
+		SearchContext::AStar search;
+		bool searching = false;
+		uint64_t searchVersion = 0;
+	};
+}
@@ -1,165 +1,123 @@
 #include "Search.h"
+#include "LineOfSight.h"
+#include "WorkStealingPool.h"
+#include <numeric>
 
 namespace VulkanProject
 {
-    Path Search::path = Path();
-    // G-values - shortest distance found so far from start node to current
-    std::unordered_map<Tile, double> Search::gValues = std::unordered_map<Tile, double>();
-    std::unordered_map<Tile, double> Search::nodeFValues = std::unordered_map<Tile, double>();
-    std::vector<Tile> Search::openNodes = std::vector<Tile>();
-    std::vector<Tile> Search::closedNodes = std::vector<Tile>();
+    std::unordered_map<int, std::shared_ptr<Search::AgentPlanner>> Search::agentPlanners = std::unordered_map<int, std::shared_ptr<Search::AgentPlanner>>();
+    std::mutex Search::agentMutex;
+    thread_local bool Search::lastQueryCached = false;
 
-    Path Search::generatePath(int start[2], int goal[2])
+    Path Search::generatePath(int start[2], int goal[2], SearchContext::SEARCH_MODE mode, SearchStats* stats)
     {
-        path = Path(start, goal);
+        return getPathCache()->generatePath(getThreadContext(), start, goal, mode, stats, &lastQueryCached);
+    }
 
-        Tile startNode = path.getStartNode();
+    size_t Search::getExpansionCount()
+    {
+        return lastQueryCached ? 0 : getThreadContext().getExpansionCount();
+    }
 
-        gValues.insert(std::pair<Tile, double>(startNode, 0));
-        nodeFValues.insert(std::pair<Tile, double>(startNode, totalCostToReachNode(startNode) + estimatedDistanceFromCurrentToGoal(startNode)));
-        openNodes.push_back(startNode);
+    PathCache* Search::getPathCache()
+    {
+        static PathCache instance = PathCache();
+        return &instance;
+    }
 
-        while (!openNodes.empty())
+    void Search::generatePaths(std::span<const PathQuery> queries, std::span<Path> results, unsigned int threadCount, SearchContext::SEARCH_MODE mode)
+    {
+        if (results.size() < queries.size())
         {
-            Tile current = openNodes.back();
-            for (auto& entry : nodeFValues)
-            {
-                // Get the tile from the open list with the lowest 'f' value
-                if (std::find(openNodes.begin(), openNodes.end(), entry.first) == openNodes.end())
-                {
-                    continue;
-                }
-                double currentFCost = totalCostToReachNode(current) + estimatedDistanceFromCurrentToGoal(current);
-                if (entry.second < currentFCost)
-                {
-                    current = entry.first;
-                }
-            }
-
-            if (current.equals(path.getGoalNode()))
-            {
-                std::cout << "Path Found." << std::endl;
-
-                std::vector<Tile> sequence = std::vector<Tile>();
-                Tile* parent = new Tile(&current);
-                while (!parent->equals(path.getStartNode()))
-                {
-                    sequence.push_back(parent);
-                    parent = parent->getParent();
-                }
-                std::reverse(sequence.begin(), sequence.end());
-                path.setSequence(sequence);
-                return path;
-            }
-
-            std::vector<Tile> neighbors = getAdjacentNodes(current);
-
-            Tile previousNeighbor = Tile(-1, -1, true);
-
-            for (Tile neighbor : neighbors)
-            {
-                if (std::find(closedNodes.begin(), closedNodes.end(), neighbor) == closedNodes.end())
-                {
-                    if (std::find(openNodes.begin(), openNodes.end(), neighbor) == openNodes.end())
-                    {
-                        neighbor.setParent(new Tile(&current));
-                        openNodes.push_back(neighbor);
-
-                        double neighborG = totalCostToReachNode(neighbor);
-                        double neighborF = neighborG + estimatedDistanceFromCurrentToGoal(neighbor);
-
-                        nodeFValues.insert(std::pair<Tile, double> { neighbor, neighborF });
-                        gValues.insert(std::pair<Tile, double> { neighbor, neighborG });
-                    }
-                }
-                else
-                {
-                    if (previousNeighbor.getX() != -1 && previousNeighbor.getY() != -1)
-                    {
-                        if (nodeFValues.at(previousNeighbor) < totalCostToReachNode(neighbor))
-                        {
-                            neighbor.setParent(new Tile(&current));
-
-                            double neighborG = totalCostToReachNode(current) + distanceBetweenNodes(current, neighbor);
-                            double neighborF = neighborG + estimatedDistanceFromCurrentToGoal(neighbor);
-
-                            nodeFValues.insert(std::pair<Tile, double> { neighbor, neighborF });
-                            gValues.insert(std::pair<Tile, double> { neighbor, neighborG });
+            throw std::runtime_error("Not enough room for path results!");
+        }
 
-                            if (std::find(closedNodes.begin(), closedNodes.end(), neighbor) != closedNodes.end())
-                            {
-                                openNodes.push_back(neighbor);
-                            }
-                        }
-                    }
-                }
-                previousNeighbor = neighbor;
-            }
+        // Load the grid up front; afterwards the workers only read it
+        Grid::ensureLoaded();
 
-            for (std::vector<Tile>::iterator iter = openNodes.begin(); iter != openNodes.end(); iter++) {
-                if (current.equals(*iter))
-                {
-                    openNodes.erase(iter);
-                    break;
-                }
-            }
-            closedNodes.push_back(current);
+        // Queries starting close together read the same grid rows, so neighbours in this order share caches
+        std::vector<uint64_t> keys = std::vector<uint64_t>(queries.size());
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            keys[i] = mortonCode(queries[i].start[0], queries[i].start[1]);
         }
+        std::vector<uint32_t> order = std::vector<uint32_t>(queries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
 
-        std::cout << "No Path Found." << std::endl;
-
-        return path;
+        // The pool's threads persist, so each one's thread_local context keeps its tables from batch to batch
+        WorkStealingPool::getInstance()->run(queries.size(), threadCount, [&](size_t task)
+        {
+            uint32_t query = order[task];
+            results[query] = getPathCache()->generatePath(getThreadContext(), queries[query].start, queries[query].goal, mode,
+                nullptr, &lastQueryCached);
+        });
     }
 
-    bool Search::lineOfSight(Tile current, Tile neighbor)
+    Path Search::replan(int agent, const int start[2], const int goal[2])
     {
-        return false;
+        std::shared_ptr<AgentPlanner> planner = getAgentPlanner(agent, true);
+        std::lock_guard<std::mutex> lock(planner->mutex);
+        return planner->search.generatePath(start, goal);
     }
 
-    double Search::totalCostToReachNode(Tile current)
+    size_t Search::getAgentExpansionCount(int agent)
     {
-        for (const std::pair<Tile, double>& entry : gValues)
+        std::shared_ptr<AgentPlanner> planner = getAgentPlanner(agent, false);
+        if (planner == nullptr)
         {
-            if (entry.first.getX() == current.getX() &&
-                entry.first.getY() == current.getY() &&
-                entry.first.isBarrier() == current.isBarrier())
-            {
-                return entry.second;
-            }
+            return 0;
         }
-        return gValues.at(path.getCurrentEndNode()) + 1;
+        std::lock_guard<std::mutex> lock(planner->mutex);
+        return planner->search.getExpansionCount();
     }
 
-    double Search::estimatedDistanceFromCurrentToGoal(Tile current)
+    void Search::forgetAgent(int agent)
     {
-        // This assumes a direct diagonal line of sight
-        double horizontalDistance = pow(path.getGoalNode().getX() - current.getX(), 2);
-        double verticalDistance = pow(path.getGoalNode().getY() - current.getY(), 2);
-        double diagDistance = sqrt(horizontalDistance + verticalDistance);
+        // A replan still running keeps its planner alive until it returns
+        std::lock_guard<std::mutex> lock(agentMutex);
+        agentPlanners.erase(agent);
+    }
 
-        return diagDistance;
+    bool Search::lineOfSight(Tile current, Tile neighbor)
+    {
+        return LineOfSight::isVisible(current.getX(), current.getY(), neighbor.getX(), neighbor.getY());
     }
 
-    std::vector<Tile> Search::getAdjacentNodes(Tile current)
+    SearchContext& Search::getThreadContext()
     {
-        std::vector<Tile> neighbors = std::vector<Tile>();
-        std::vector<Tile> grid = Grid::getGrid();
-        for (std::vector<Tile>::iterator iter = grid.begin(); iter != grid.end(); iter++) {
-            if (abs((*iter).getX() - current.getX()) <= 1 &&
-                abs((*iter).getY() - current.getY()) <= 1 &&
-                !(*iter).isBarrier() &&
-                !current.equals(*iter))
-            {
-                neighbors.push_back(*iter);
-            }
-        }
+        // Each thread keeps its own scratch state, so concurrent callers never share tables
+        thread_local SearchContext context = SearchContext();
+        return context;
+    }
 
-        return neighbors;
+    std::shared_ptr<Search::AgentPlanner> Search::getAgentPlanner(int agent, bool create)
+    {
+        std::lock_guard<std::mutex> lock(agentMutex);
+        auto planner = agentPlanners.find(agent);
+        if (planner != agentPlanners.end())
+        {
+            return planner->second;
+        }
+        if (!create)
+        {
+            return nullptr;
+        }
+        return agentPlanners[agent] = std::make_shared<AgentPlanner>();
     }
 
-    double Search::distanceBetweenNodes(Tile current, Tile neighbor)
+    uint64_t Search::mortonCode(int x, int y)
     {
-        // The abs method below may need to be removed
-        return abs(totalCostToReachNode(neighbor) - totalCostToReachNode(current));
+        // Interleaves the bits of x and y, x taking the even positions
+        auto spread = [](uint64_t value)
+        {
+            value = (value | (value << 16)) & 0x0000FFFF0000FFFF;
+            value = (value | (value << 8)) & 0x00FF00FF00FF00FF;
+            value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0F;
+            value = (value | (value << 2)) & 0x3333333333333333;
+            value = (value | (value << 1)) & 0x5555555555555555;
+            return value;
+        };
+        return spread((uint32_t)x) | (spread((uint32_t)y) << 1);
     }
 }
@@ -1,6 +1,9 @@
 #pragma once
-#include "Grid.h"
-#include "Path.h"
+#include "IncrementalSearch.h"
+#include "PathCache.h"
+#include "SearchContext.h"
+#include <memory>
+#include <span>
 #include <unordered_map>
 
 namespace VulkanProject
@@ -8,18 +11,44 @@ namespace VulkanProject
 	class Search
 	{
 	public:
-		static Path generatePath(int start[2], int goal[2]);
-	private:
-		static std::vector<Tile> getAdjacentNodes(Tile current);
+		// Repeated queries are answered from getPathCache(). 'stats', when given, receives what the query cost
+		// (see SearchContext::generatePath), and is empty when the cache answered it
+		static Path generatePath(int start[2], int goal[2], SearchContext::SEARCH_MODE mode = SearchContext::SEARCH_MODE::A_STAR,
+			SearchStats* stats = nullptr);
+		// Solves every query on the shared WorkStealingPool (threadCount 0 = one per hardware thread); results[i]
+		// answers queries[i]. Queries are solved in Morton order of their start tile, so each worker's share covers
+		// one compact patch of the map.
+		static void generatePaths(std::span<const PathQuery> queries, std::span<Path> results, unsigned int threadCount = 0,
+			SearchContext::SEARCH_MODE mode = SearchContext::SEARCH_MODE::A_STAR);
+		// Nodes expanded by the calling thread's most recent generatePath, 0 when the cache answered it
+		static size_t getExpansionCount();
+		// Shared by generatePath and generatePaths; clear it or lower its budget to measure searches alone
+		static PathCache* getPathCache();
+		// Plans for one agent with a D* Lite planner kept for it between calls (see IncrementalSearch): replanning
+		// towards the same goal after grid edits only repairs what the edits changed. Agent ids are the caller's
+		// choice, and different agents may replan on different threads at once. Every planner holds tables
+		// for the whole grid, so forget agents that stop moving.
+		static Path replan(int agent, const int start[2], const int goal[2]);
+		// Nodes expanded by the agent's most recent replan, 0 for an unknown agent
+		static size_t getAgentExpansionCount(int agent);
+		static void forgetAgent(int agent);
 		static bool lineOfSight(Tile current, Tile neighbor);
-		static double totalCostToReachNode(Tile current);
-		static double inline distanceBetweenNodes(Tile current, Tile neighbor);
-		static double inline estimatedDistanceFromCurrentToGoal(Tile current);
 
-		static Path path;
-		static std::unordered_map<Tile, double> gValues;
-		static std::unordered_map<Tile, double> nodeFValues;
-		static std::vector<Tile> openNodes;
-		static std::vector<Tile> closedNodes;
+	private:
+		// Locked for each replan, so one agent never plans on two threads at once
+		struct AgentPlanner
+		{
+			std::mutex mutex;
+			IncrementalSearch search;
+		};
+
+		static SearchContext& getThreadContext();
+		static std::shared_ptr<AgentPlanner> getAgentPlanner(int agent, bool create);
+		static uint64_t mortonCode(int x, int y);
+
+		// Whether the calling thread's most recent generatePath was a cache hit
+		static thread_local bool lastQueryCached;
+		static std::unordered_map<int, std::shared_ptr<AgentPlanner>> agentPlanners;
+		static std::mutex agentMutex;
 	};
 }
@@ -0,0 +1,467 @@
+#include "SearchContext.h"
+#include "FlowFieldCache.h"
+#include "LineOfSight.h"
+#include <chrono>
+
+namespace VulkanProject
+{
+    SearchContext::SearchContext()
+    {
+    }
+
+    SearchContext::~SearchContext()
+    {
+    }
+
+    Path SearchContext::generatePath(const int start[2], const int goal[2], SEARCH_MODE mode, SearchStats* stats)
+    {
+#ifdef SEARCH_STATS
+        SearchStats queryStats = SearchStats();
+        if (stats == nullptr)
+        {
+            stats = &queryStats;
+        }
+#endif
+        setCounting(stats != nullptr);
+        if (stats == nullptr)
+        {
+            return findPath(start, goal, mode);
+        }
+
+        std::chrono::steady_clock::time_point queryStart = std::chrono::steady_clock::now();
+        size_t bytesAtQueryStart = countAllocatedBytes();
+        findPath(start, goal, mode);
+
+        *stats = SearchStats();
+        stats->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStart).count();
+        stats->bytesAllocated = countAllocatedBytes() - bytesAtQueryStart;
+        addStats(*stats);
+        SearchCounters::getInstance()->record(*stats);
+        return path;
+    }
+
+    Path SearchContext::findPath(const int start[2], const int goal[2], SEARCH_MODE mode)
+    {
+        path = Path(start, goal);
+        goalX = goal[0];
+        goalY = goal[1];
+        queryMode = mode;
+        querySearched = false;
+
+        // Make sure the barrier file has been loaded before indexing into the grid
+        Grid::ensureLoaded();
+        allocationsAtQueryStart = countAllocations();
+
+        // Start and goal in different regions: fail in O(1) instead of exploring everything reachable
+        if (!Grid::areConnected(start[0], start[1], goal[0], goal[1]))
+        {
+            LOG("No Path Found.");
+            expansionCount = 0;
+            allocationCount = 0;
+            return path;
+        }
+        querySearched = true;
+
+        if (mode == SEARCH_MODE::BIDIRECTIONAL || mode == SEARCH_MODE::PARALLEL_BIDIRECTIONAL)
+        {
+            path = bidirectional.generatePath(start, goal, mode == SEARCH_MODE::PARALLEL_BIDIRECTIONAL);
+            expansionCount = bidirectional.getExpansionCount();
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        if (mode == SEARCH_MODE::A_STAR)
+        {
+            path = aStar.generatePath(start, goal);
+            expansionCount = aStar.getExpansionCount();
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        if (mode == SEARCH_MODE::ANYTIME)
+        {
+            path = anytime.generatePath(start, goal);
+            expansionCount = anytime.getExpansionCount();
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        if (mode == SEARCH_MODE::HPA)
+        {
+            refreshHierarchy();
+            path = hierarchical.generatePath(start, goal);
+            expansionCount = hierarchical.getExpansionCount();
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        if (mode == SEARCH_MODE::FLOW_FIELD)
+        {
+            std::shared_ptr<const FlowField> field = FlowFieldCache::getInstance()->getField(goal);
+            path = field->generatePath(start);
+            expansionCount = 0;
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        reset();
+
+        LandmarkHeuristic* heuristic = LandmarkHeuristic::getInstance();
+        if (mode == SEARCH_MODE::LANDMARKS)
+        {
+            heuristic->ensurePrepared();
+        }
+        landmarks = (mode == SEARCH_MODE::LANDMARKS && heuristic->isCurrent()) ? heuristic : nullptr;
+
+        if (!Grid::inBounds(start[0], start[1]) || !Grid::inBounds(goalX, goalY))
+        {
+            LOG("No Path Found.");
+            allocationCount = countAllocations() - allocationsAtQueryStart;
+            return path;
+        }
+
+        int startIndex = Grid::indexOf(start[0], start[1]);
+        int goalIndex = Grid::indexOf(goalX, goalY);
+
+        nodes.open(startIndex, 0, NodeTable::NO_PARENT);
+        openNodes.push(startIndex, estimatedDistanceFromCurrentToGoal(startIndex));
+
+        while (!openNodes.empty())
+        {
+            // Get the tile from the open list with the lowest 'f' value
+            int currentIndex = openNodes.pop();
+            expansionCount++;
+
+            // Lazy Theta* only verifies the parent's line of sight once a node is expanded
+            if (mode == SEARCH_MODE::LAZY_THETA_STAR)
+            {
+                setVertex(currentIndex);
+            }
+
+            if (currentIndex == goalIndex)
+            {
+                LOG("Path Found.");
+
+                bool anyAngle = (mode == SEARCH_MODE::THETA_STAR || mode == SEARCH_MODE::LAZY_THETA_STAR);
+                buildSequence(startIndex, goalIndex, !anyAngle);
+                allocationCount = countAllocations() - allocationsAtQueryStart;
+                return path;
+            }
+
+            nodes.close(currentIndex);
+
+            switch (mode)
+            {
+            case SEARCH_MODE::JUMP_POINT:
+                expandJumpPoints(currentIndex);
+                break;
+            case SEARCH_MODE::THETA_STAR:
+                expandAnyAngle(currentIndex);
+                break;
+            case SEARCH_MODE::LAZY_THETA_STAR:
+                expandLazyAnyAngle(currentIndex);
+                break;
+            default:
+                expandNeighbors(currentIndex);
+                break;
+            }
+        }
+
+        LOG("No Path Found.");
+
+        allocationCount = countAllocations() - allocationsAtQueryStart;
+        return path;
+    }
+
+    size_t SearchContext::getAllocationCount() const
+    {
+        return allocationCount;
+    }
+
+    size_t SearchContext::getExpansionCount() const
+    {
+        return expansionCount;
+    }
+
+    double SearchContext::getSuboptimalityBound() const
+    {
+        return anytime.getSuboptimalityBound();
+    }
+
+    void SearchContext::addStats(SearchStats& stats) const
+    {
+        if (!querySearched)
+        {
+            return;
+        }
+
+        switch (queryMode)
+        {
+        case SEARCH_MODE::A_STAR:
+            aStar.addStats(stats);
+            break;
+        case SEARCH_MODE::ANYTIME:
+            anytime.addStats(stats);
+            break;
+        case SEARCH_MODE::BIDIRECTIONAL:
+        case SEARCH_MODE::PARALLEL_BIDIRECTIONAL:
+            bidirectional.addStats(stats);
+            break;
+        case SEARCH_MODE::HPA:
+            hierarchical.addStats(stats);
+            break;
+        case SEARCH_MODE::FLOW_FIELD:
+            // Walking a cached field expands nothing
+            break;
+        default:
+            stats.nodesExpanded += expansionCount;
+            stats.nodesGenerated += generatedCount;
+            openNodes.addStats(stats);
+            break;
+        }
+    }
+
+    void SearchContext::setCounting(bool counting)
+    {
+        // Only pays for a call per search when the setting changes
+        if (this->counting == counting)
+        {
+            return;
+        }
+        this->counting = counting;
+        openNodes.setCounting(counting);
+        aStar.setCounting(counting);
+        anytime.setCounting(counting);
+        bidirectional.setCounting(counting);
+        hierarchical.setCounting(counting);
+    }
+
+    void SearchContext::reset()
+    {
+        // Bumping the generation invalidates every record from the previous query in O(1). A paged grid may not
+        // fit in memory, so neither may tables sized to it: those queries use sparse ones.
+        int nodeCount = Grid::getWidth() * Grid::getHeight();
+        nodes.beginQuery(nodeCount, Grid::isPaged());
+        openNodes.resize(nodeCount, Grid::isPaged());
+        expansionCount = 0;
+        generatedCount = 0;
+    }
+
+    void SearchContext::refreshHierarchy()
+    {
+        if (hierarchyVersion == Grid::getVersion())
+        {
+            return;
+        }
+
+        // Building the abstraction searches inside every cluster, so it is done once for all contexts; copying the
+        // result is much cheaper, and lets the contexts search concurrently
+        static HierarchicalSearch sharedHierarchy = HierarchicalSearch();
+        static std::mutex sharedHierarchyMutex;
+        std::lock_guard<std::mutex> lock(sharedHierarchyMutex);
+        sharedHierarchy.update();
+        hierarchical = sharedHierarchy;
+        hierarchical.setCounting(counting);
+        hierarchyVersion = Grid::getVersion();
+    }
+
+    void SearchContext::expandNeighbors(int currentIndex)
+    {
+        int width = Grid::getWidth();
+        for (uint32_t moves = EightConnected::allowedMoves(currentIndex % width, currentIndex / width); moves != 0; moves &= moves - 1)
+        {
+            int direction = std::countr_zero(moves);
+            int neighborIndex = currentIndex + Grid::DIRECTION_Y[direction] * width + Grid::DIRECTION_X[direction];
+            relax(currentIndex, neighborIndex, direction < 4 ? CostModel<double>::ORTHOGONAL : CostModel<double>::DIAGONAL);
+        }
+    }
+
+    void SearchContext::expandJumpPoints(int currentIndex)
+    {
+        int successors[JumpPointSearch::MAX_SUCCESSORS];
+        int successorCount = JumpPointSearch::findSuccessors(currentIndex % Grid::getWidth(), currentIndex / Grid::getWidth(),
+            nodes.getParent(currentIndex), goalX, goalY, successors);
+
+        for (int i = 0; i < successorCount; i++)
+        {
+            relax(currentIndex, successors[i], distanceBetweenNodes(currentIndex, successors[i]));
+        }
+    }
+
+    void SearchContext::expandAnyAngle(int currentIndex)
+    {
+        // Theta*: connect each neighbor straight to the current node's parent whenever it can see it
+        int parentIndex = nodes.getParent(currentIndex);
+        Tile current = Grid::at(currentIndex);
+        for (Tile neighbor : Grid::neighbors(current.getX(), current.getY()))
+        {
+            int neighborIndex = Grid::indexOf(neighbor.getX(), neighbor.getY());
+            if (nodes.getState(neighborIndex) == NodeTable::NodeState::CLOSED)
+            {
+                continue;
+            }
+
+            if (parentIndex != NodeTable::NO_PARENT && hasLineOfSight(parentIndex, neighborIndex))
+            {
+                relax(parentIndex, neighborIndex, straightLineDistance(parentIndex, neighborIndex));
+            }
+            else
+            {
+                relax(currentIndex, neighborIndex, straightLineDistance(currentIndex, neighborIndex));
+            }
+        }
+    }
+
+    void SearchContext::expandLazyAnyAngle(int currentIndex)
+    {
+        // Lazy Theta*: optimistically connect every neighbor to the current node's parent;
+        // setVertex repairs the link if the line turns out to be blocked when the neighbor is expanded
+        int parentIndex = nodes.getParent(currentIndex);
+        int fromIndex = (parentIndex != NodeTable::NO_PARENT) ? parentIndex : currentIndex;
+        Tile current = Grid::at(currentIndex);
+        for (Tile neighbor : Grid::neighbors(current.getX(), current.getY()))
+        {
+            int neighborIndex = Grid::indexOf(neighbor.getX(), neighbor.getY());
+            relax(fromIndex, neighborIndex, straightLineDistance(fromIndex, neighborIndex));
+        }
+    }
+
+    void SearchContext::setVertex(int currentIndex)
+    {
+        int parentIndex = nodes.getParent(currentIndex);
+        if (parentIndex == NodeTable::NO_PARENT || hasLineOfSight(parentIndex, currentIndex))
+        {
+            return;
+        }
+
+        // Fall back to the best already-expanded neighbor, which always exists because one of them generated this node
+        double bestG = NodeTable::UNREACHED;
+        int bestParent = NodeTable::NO_PARENT;
+        Tile current = Grid::at(currentIndex);
+        for (Tile neighbor : Grid::neighbors(current.getX(), current.getY()))
+        {
+            int neighborIndex = Grid::indexOf(neighbor.getX(), neighbor.getY());
+            if (nodes.getState(neighborIndex) != NodeTable::NodeState::CLOSED)
+            {
+                continue;
+            }
+
+            double g = nodes.getG(neighborIndex) + straightLineDistance(neighborIndex, currentIndex);
+            if (g < bestG)
+            {
+                bestG = g;
+                bestParent = neighborIndex;
+            }
+        }
+        nodes.reparent(currentIndex, bestG, bestParent);
+    }
+
+    bool SearchContext::hasLineOfSight(int from, int to)
+    {
+        int width = Grid::getWidth();
+        return LineOfSight::isVisible(from % width, from / width, to % width, to / width);
+    }
+
+    void SearchContext::relax(int currentIndex, int neighborIndex, double stepCost)
+    {
+        NodeTable::NodeState state = nodes.getState(neighborIndex);
+        SEARCH_STATS_COUNT(counting, generatedCount);
+        if (state == NodeTable::NodeState::CLOSED)
+        {
+            return;
+        }
+
+        double neighborG = nodes.getG(currentIndex) + stepCost;
+        if (neighborG >= nodes.getG(neighborIndex))
+        {
+            return;
+        }
+
+        nodes.open(neighborIndex, neighborG, currentIndex);
+
+        double neighborF = neighborG + estimatedDistanceFromCurrentToGoal(neighborIndex);
+        if (state == NodeTable::NodeState::OPEN)
+        {
+            openNodes.decreaseKey(neighborIndex, neighborF);
+        }
+        else
+        {
+            openNodes.push(neighborIndex, neighborF);
+        }
+    }
+
+    size_t SearchContext::countAllocations() const
+    {
+        return nodes.getAllocationCount() + openNodes.getAllocationCount() + aStar.getAllocationCount() + anytime.getAllocationCount() + bidirectional.getAllocationCount();
+    }
+
+    size_t SearchContext::countAllocatedBytes() const
+    {
+        return nodes.getAllocatedBytes() + openNodes.getAllocatedBytes() + aStar.getAllocatedBytes() + anytime.getAllocatedBytes() + bidirectional.getAllocatedBytes();
+    }
+
+    void SearchContext::buildSequence(int startIndex, int goalIndex, bool interpolate)
+    {
+        // Parent links may skip several tiles along a straight or diagonal line (jump points),
+        // so when interpolating each link contributes as many tiles as its longest axis.
+        // Any-angle paths keep just the waypoints.
+        int width = Grid::getWidth();
+        size_t length = 0;
+        for (int node = goalIndex; node != startIndex; node = nodes.getParent(node))
+        {
+            int parent = nodes.getParent(node);
+            length += interpolate ? std::max(abs(node % width - parent % width), abs(node / width - parent / width)) : 1;
+        }
+
+        // Follow the parent indices a second time, filling the result back to front
+        std::vector<Tile> sequence = std::vector<Tile>(length);
+        for (int node = goalIndex; node != startIndex; node = nodes.getParent(node))
+        {
+            if (!interpolate)
+            {
+                sequence[--length] = Grid::at(node);
+                continue;
+            }
+
+            int parent = nodes.getParent(node);
+            int stepX = (parent % width > node % width) - (parent % width < node % width);
+            int stepY = (parent / width > node / width) - (parent / width < node / width);
+            for (int tile = node; tile != parent; tile += stepY * width + stepX)
+            {
+                sequence[--length] = Grid::at(tile);
+            }
+        }
+        path.setSequence(std::move(sequence));
+    }
+
+    double SearchContext::estimatedDistanceFromCurrentToGoal(int current)
+    {
+        // This assumes a direct diagonal line of sight, which any-angle paths can actually take
+        double dx = goalX - current % Grid::getWidth();
+        double dy = goalY - current / Grid::getWidth();
+        double diagDistance = sqrt(dx * dx + dy * dy);
+
+        // Both are lower bounds, so the larger one is too
+        if (landmarks != nullptr)
+        {
+            return std::max(diagDistance, landmarks->estimate(current, Grid::indexOf(goalX, goalY)));
+        }
+        return diagDistance;
+    }
+
+    double SearchContext::straightLineDistance(int from, int to)
+    {
+        double dx = from % Grid::getWidth() - to % Grid::getWidth();
+        double dy = from / Grid::getWidth() - to / Grid::getWidth();
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    double SearchContext::distanceBetweenNodes(int current, int neighbor)
+    {
+        // Octile distance: diagonal steps cost sqrt(2), orthogonal steps cost 1.
+        // Neighbors are one step apart; jump points lie on a straight or diagonal line.
+        int dx = abs(current % Grid::getWidth() - neighbor % Grid::getWidth());
+        int dy = abs(current / Grid::getWidth() - neighbor / Grid::getWidth());
+        return sqrt(2.0) * std::min(dx, dy) + abs(dx - dy);
+    }
+}
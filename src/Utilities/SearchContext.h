@@ -0,0 +1,116 @@
+#pragma once
+#include "AnytimeSearch.h"
+#include "BasicSearch.h"
+#include "BidirectionalSearch.h"
+#include "Grid.h"
+#include "HierarchicalSearch.h"
+#include "IndexedHeap.h"
+#include "JumpPointSearch.h"
+#include "LandmarkHeuristic.h"
+#include "NodeTable.h"
+#include "Path.h"
+
+namespace VulkanProject
+{
+	// Start and goal coordinates of a single path request
+	struct PathQuery
+	{
+		int start[2];
+		int goal[2];
+	};
+
+	// Owns all scratch state for one A* query at a time. The grid is only read, so separate
+	// contexts can search concurrently as long as nobody edits the grid meanwhile.
+	class SearchContext
+	{
+	public:
+		// Plain A*: octile estimate, moves may cut corners like every other mode, costs in tiles
+		typedef BasicSearch<OctileHeuristic, EightConnected, double> AStar;
+
+		enum class SEARCH_MODE
+		{
+			// Runs the AStar instantiation of BasicSearch
+			A_STAR,
+			JUMP_POINT,
+			// Any-angle modes: paths are returned as waypoints joined by straight, unobstructed lines
+			THETA_STAR,
+			LAZY_THETA_STAR,
+			// Searches from both ends and meets in the middle; the parallel variant grows the goal side on a second thread
+			BIDIRECTIONAL,
+			PARALLEL_BIDIRECTIONAL,
+			// Walks a flow field for the goal from FlowFieldCache; queries sharing a goal share one reverse search
+			FLOW_FIELD,
+			// A* guided by LandmarkHeuristic's tables, loaded or built by the first query on each new grid (see
+			// LandmarkHeuristic::ensurePrepared); plain A* while edits leave them stale
+			LANDMARKS,
+			// ARA* under AnytimeSearch's default limits: the best path found in time, see getSuboptimalityBound()
+			ANYTIME,
+			// HPA* over 16x16 clusters (see HierarchicalSearch). Paths are near-optimal, not shortest: they follow
+			// cluster entrances, typically a few percent longer. One shared abstraction is built on first use and
+			// kept up to date with grid edits; each context searches its own copy of it.
+			HPA
+		};
+		// On a paged grid (see Grid::loadGridFile) A_STAR, JUMP_POINT, the any-angle modes and LANDMARKS keep
+		// sparse scratch tables that grow with the search. The other modes still allocate state for every tile,
+		// and LANDMARKS' own tables cover the whole grid, so those suit paged grids only while that fits in memory.
+
+		SearchContext();
+		~SearchContext();
+		// 'stats', when given, receives what the query cost and is added to SearchCounters. SEARCH_STATS builds
+		// measure and record every query; other builds only pay for measuring when stats are asked for.
+		Path generatePath(const int start[2], const int goal[2], SEARCH_MODE mode = SEARCH_MODE::A_STAR, SearchStats* stats = nullptr);
+		// Scratch allocations made by the most recent query; zero once the tables have warmed up
+		size_t getAllocationCount() const;
+		// Nodes taken off the open list by the most recent query
+		size_t getExpansionCount() const;
+		// How far the most recent ANYTIME path may be from optimal, as a factor of the optimal cost
+		double getSuboptimalityBound() const;
+
+	private:
+		Path findPath(const int start[2], const int goal[2], SEARCH_MODE mode);
+		void addStats(SearchStats& stats) const;
+		void setCounting(bool counting);
+		void reset();
+		void refreshHierarchy();
+		void expandNeighbors(int currentIndex);
+		void expandJumpPoints(int currentIndex);
+		void expandAnyAngle(int currentIndex);
+		void expandLazyAnyAngle(int currentIndex);
+		void setVertex(int currentIndex);
+		bool hasLineOfSight(int from, int to);
+		void relax(int currentIndex, int neighborIndex, double stepCost);
+		size_t countAllocations() const;
+		size_t countAllocatedBytes() const;
+		void buildSequence(int startIndex, int goalIndex, bool interpolate);
+		double inline distanceBetweenNodes(int current, int neighbor);
+		double inline straightLineDistance(int from, int to);
+		double inline estimatedDistanceFromCurrentToGoal(int current);
+
+		Path path;
+		int goalX = 0;
+		int goalY = 0;
+		// Set for LANDMARKS queries when current tables exist
+		const LandmarkHeuristic* landmarks = nullptr;
+		// G-values, parent links and open/closed flags for every tile, keyed by grid index.
+		// The table doubles as the query's node pool: ending a query just bumps its generation.
+		NodeTable nodes;
+		// Open nodes are keyed by grid index and ordered by their 'f' value
+		IndexedHeap openNodes;
+		AStar aStar;
+		AnytimeSearch anytime;
+		// Second frontier and meeting state for the bidirectional modes
+		BidirectionalSearch bidirectional;
+		HierarchicalSearch hierarchical;
+		// Grid version 'hierarchical' was copied for, 0 before the first HPA query
+		uint64_t hierarchyVersion = 0;
+		size_t allocationsAtQueryStart = 0;
+		size_t allocationCount = 0;
+		size_t expansionCount = 0;
+		size_t generatedCount = 0;
+		// Set for queries that asked for stats; the searches only count then
+		bool counting = false;
+		// Which search answered the most recent query, so its counts can be collected; none if it failed up front
+		SEARCH_MODE queryMode = SEARCH_MODE::A_STAR;
+		bool querySearched = false;
+	};
+}
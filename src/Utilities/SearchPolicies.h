@@ -0,0 +1,150 @@
+#pragma once
+#include "Grid.h"
+#include <bit>
+#include <limits>
+#include <type_traits>
+
+namespace VulkanProject
+{
+	// Step costs for a cost type. Floating point costs count tiles; integer costs are fixed point, with the
+	// diagonal rounded down so that the octile estimate below stays a lower bound.
+	template <typename CostType, bool = std::is_floating_point_v<CostType>>
+	struct CostModel
+	{
+		static constexpr CostType ORTHOGONAL = 1;
+		static constexpr CostType DIAGONAL = (CostType)1.4142135623730951;
+		static constexpr CostType UNREACHED = std::numeric_limits<CostType>::infinity();
+
+		static double toTiles(CostType cost)
+		{
+			return (double)cost;
+		}
+	};
+
+	template <typename CostType>
+	struct CostModel<CostType, false>
+	{
+		// 64-bit costs can afford more fractional bits than 32-bit ones before long paths overflow
+		static constexpr CostType ORTHOGONAL = sizeof(CostType) >= 8 ? (CostType)1 << 20 : (CostType)1 << 10;
+		static constexpr CostType DIAGONAL = (CostType)(ORTHOGONAL * 1.4142135623730951);
+		static constexpr CostType UNREACHED = std::numeric_limits<CostType>::max();
+
+		static double toTiles(CostType cost)
+		{
+			return (double)cost / ORTHOGONAL;
+		}
+	};
+
+	// Heuristics take the absolute offsets to the goal
+
+	// Lower bound for 4-connected moves only
+	struct ManhattanHeuristic
+	{
+		template <typename CostType>
+		static CostType estimate(int dx, int dy)
+		{
+			return CostModel<CostType>::ORTHOGONAL * (CostType)(dx + dy);
+		}
+	};
+
+	// Exact cost on an open 8-connected grid
+	struct OctileHeuristic
+	{
+		template <typename CostType>
+		static CostType estimate(int dx, int dy)
+		{
+			int diagonal = std::min(dx, dy);
+			return CostModel<CostType>::DIAGONAL * (CostType)diagonal + CostModel<CostType>::ORTHOGONAL * (CostType)(dx + dy - 2 * diagonal);
+		}
+	};
+
+	// Counts every move as orthogonal: weaker than octile, but admissible for either connectivity
+	struct ChebyshevHeuristic
+	{
+		template <typename CostType>
+		static CostType estimate(int dx, int dy)
+		{
+			return CostModel<CostType>::ORTHOGONAL * (CostType)std::max(dx, dy);
+		}
+	};
+
+	// Connectivities decide which of Grid::DIRECTION_X/Y may be taken from a tile, as a mask with bit d set when
+	// direction d is allowed. A move never enters a barrier; the eight-connected variants differ in how diagonal
+	// moves treat the two tiles they pass between. Bits 0-3 are east, south, west and north; the diagonals in
+	// bits 4-7 (south-east, south-west, north-west, north-east) each pass between two of those.
+
+	struct FourConnected
+	{
+		static constexpr int DIRECTION_COUNT = 4;
+
+		static uint32_t allowedMoves(int x, int y)
+		{
+			return Grid::getOpenNeighbors(x, y) & 0x0F;
+		}
+
+		static bool canMove(int x, int y, int direction)
+		{
+			return (allowedMoves(x, y) >> direction) & 1;
+		}
+	};
+
+	// Diagonal moves may pass between two barriers, like every SearchContext mode
+	struct EightConnected
+	{
+		static constexpr int DIRECTION_COUNT = Grid::DIRECTION_COUNT;
+
+		static uint32_t allowedMoves(int x, int y)
+		{
+			return Grid::getOpenNeighbors(x, y);
+		}
+
+		static bool canMove(int x, int y, int direction)
+		{
+			return (allowedMoves(x, y) >> direction) & 1;
+		}
+	};
+
+	// Diagonal moves need at least one of the two tiles they pass between to be open
+	struct EightConnectedNoSqueezing
+	{
+		static constexpr int DIRECTION_COUNT = Grid::DIRECTION_COUNT;
+
+		static uint32_t allowedMoves(int x, int y)
+		{
+			uint32_t open = Grid::getOpenNeighbors(x, y);
+			uint32_t east = open & 1;
+			uint32_t south = open >> 1 & 1;
+			uint32_t west = open >> 2 & 1;
+			uint32_t north = open >> 3 & 1;
+			uint32_t sides = (east | south) | (west | south) << 1 | (west | north) << 2 | (east | north) << 3;
+			return open & (0x0F | sides << 4);
+		}
+
+		static bool canMove(int x, int y, int direction)
+		{
+			return (allowedMoves(x, y) >> direction) & 1;
+		}
+	};
+
+	// Diagonal moves need both tiles they pass between to be open, so paths never clip a corner
+	struct EightConnectedNoCornerCutting
+	{
+		static constexpr int DIRECTION_COUNT = Grid::DIRECTION_COUNT;
+
+		static uint32_t allowedMoves(int x, int y)
+		{
+			uint32_t open = Grid::getOpenNeighbors(x, y);
+			uint32_t east = open & 1;
+			uint32_t south = open >> 1 & 1;
+			uint32_t west = open >> 2 & 1;
+			uint32_t north = open >> 3 & 1;
+			uint32_t sides = (east & south) | (west & south) << 1 | (west & north) << 2 | (east & north) << 3;
+			return open & (0x0F | sides << 4);
+		}
+
+		static bool canMove(int x, int y, int direction)
+		{
+			return (allowedMoves(x, y) >> direction) & 1;
+		}
+	};
+}
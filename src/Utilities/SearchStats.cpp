@@ -0,0 +1,96 @@
+#include "SearchStats.h"
+#include <iomanip>
+
+namespace VulkanProject
+{
+	SearchCounters::SearchCounters()
+	{
+		reset();
+	}
+
+	SearchCounters::~SearchCounters()
+	{
+	}
+
+	SearchCounters* SearchCounters::getInstance()
+	{
+		static SearchCounters instance = SearchCounters();
+		return &instance;
+	}
+
+	void SearchCounters::record(const SearchStats& stats)
+	{
+		uint64_t queryNanoseconds = (uint64_t)(stats.milliseconds * 1e6);
+		queryCount.fetch_add(1, std::memory_order_relaxed);
+		nodesExpanded.fetch_add(stats.nodesExpanded, std::memory_order_relaxed);
+		nodesGenerated.fetch_add(stats.nodesGenerated, std::memory_order_relaxed);
+		heapPushes.fetch_add(stats.heapPushes, std::memory_order_relaxed);
+		heapPops.fetch_add(stats.heapPops, std::memory_order_relaxed);
+		heapDecreaseKeys.fetch_add(stats.heapDecreaseKeys, std::memory_order_relaxed);
+		bytesAllocated.fetch_add(stats.bytesAllocated, std::memory_order_relaxed);
+		nanoseconds.fetch_add(queryNanoseconds, std::memory_order_relaxed);
+		raise(peakOpenSize, stats.peakOpenSize);
+		raise(slowestNanoseconds, queryNanoseconds);
+	}
+
+	size_t SearchCounters::getQueryCount() const
+	{
+		return (size_t)queryCount.load(std::memory_order_relaxed);
+	}
+
+	SearchStats SearchCounters::getTotals() const
+	{
+		SearchStats totals = SearchStats();
+		totals.nodesExpanded = (size_t)nodesExpanded.load(std::memory_order_relaxed);
+		totals.nodesGenerated = (size_t)nodesGenerated.load(std::memory_order_relaxed);
+		totals.heapPushes = (size_t)heapPushes.load(std::memory_order_relaxed);
+		totals.heapPops = (size_t)heapPops.load(std::memory_order_relaxed);
+		totals.heapDecreaseKeys = (size_t)heapDecreaseKeys.load(std::memory_order_relaxed);
+		totals.peakOpenSize = (size_t)peakOpenSize.load(std::memory_order_relaxed);
+		totals.bytesAllocated = (size_t)bytesAllocated.load(std::memory_order_relaxed);
+		totals.milliseconds = nanoseconds.load(std::memory_order_relaxed) / 1e6;
+		return totals;
+	}
+
+	void SearchCounters::dump(std::ostream& output) const
+	{
+		size_t queries = getQueryCount();
+		SearchStats totals = getTotals();
+		output << "Search counters over " << queries << " queries:" << std::endl;
+		output << "  nodes expanded:     " << totals.nodesExpanded << std::endl;
+		output << "  nodes generated:    " << totals.nodesGenerated << std::endl;
+		output << "  heap pushes:        " << totals.heapPushes << std::endl;
+		output << "  heap pops:          " << totals.heapPops << std::endl;
+		output << "  heap decrease-keys: " << totals.heapDecreaseKeys << std::endl;
+		output << "  peak open size:     " << totals.peakOpenSize << std::endl;
+		output << "  bytes allocated:    " << totals.bytesAllocated << std::endl;
+		output << std::fixed << std::setprecision(3);
+		output << "  total time (ms):    " << totals.milliseconds << std::endl;
+		output << "  mean time (ms):     " << (queries > 0 ? totals.milliseconds / queries : 0) << std::endl;
+		output << "  slowest (ms):       " << slowestNanoseconds.load(std::memory_order_relaxed) / 1e6 << std::endl;
+		output << std::defaultfloat;
+	}
+
+	void SearchCounters::reset()
+	{
+		queryCount = 0;
+		nodesExpanded = 0;
+		nodesGenerated = 0;
+		heapPushes = 0;
+		heapPops = 0;
+		heapDecreaseKeys = 0;
+		peakOpenSize = 0;
+		bytesAllocated = 0;
+		nanoseconds = 0;
+		slowestNanoseconds = 0;
+	}
+
+	void SearchCounters::raise(std::atomic<uint64_t>& maximum, uint64_t value)
+	{
+		// Lock-free maximum: retry only while another thread keeps raising it below 'value'
+		uint64_t current = maximum.load(std::memory_order_relaxed);
+		while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+}
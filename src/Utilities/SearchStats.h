@@ -0,0 +1,60 @@
+#pragma once
+#include "../Core/stdafx.h"
+#include <atomic>
+#include <ostream>
+
+// Heap operations and generated nodes are counted inside the search loops only for queries that asked for
+// SearchStats: the searches take a per-query 'counting' flag (setCounting) and add it to the counter, which costs
+// an add rather than a branch. Defining SEARCH_STATS (the Debug configurations do) makes every query ask.
+#define SEARCH_STATS_COUNT(counting, counter) ((counter) += (size_t)(counting))
+
+namespace VulkanProject
+{
+	// What one path query cost, filled by SearchContext::generatePath when asked for
+	struct SearchStats
+	{
+		// Nodes taken off the open list
+		size_t nodesExpanded = 0;
+		// Successors looked at while expanding, including the ones that were not improved
+		size_t nodesGenerated = 0;
+		// Open list operations and its largest size during the query; update() counts as a decrease-key and remove() as a pop
+		size_t heapPushes = 0;
+		size_t heapPops = 0;
+		size_t heapDecreaseKeys = 0;
+		size_t peakOpenSize = 0;
+		// Growth of the scratch tables; zero once they have warmed up
+		size_t bytesAllocated = 0;
+		double milliseconds = 0;
+	};
+
+	// Process-wide totals over every recorded query. Any thread may record at any time: each field is a
+	// separate atomic updated with relaxed ordering, so a dump taken while searches run may mix queries,
+	// but no count is ever lost.
+	class SearchCounters
+	{
+	public:
+		SearchCounters();
+		~SearchCounters();
+		static SearchCounters* getInstance();
+		void record(const SearchStats& stats);
+		size_t getQueryCount() const;
+		// Sums over all recorded queries, except peakOpenSize, which is the largest seen by any of them
+		SearchStats getTotals() const;
+		void dump(std::ostream& output) const;
+		void reset();
+
+	private:
+		static void raise(std::atomic<uint64_t>& maximum, uint64_t value);
+
+		std::atomic<uint64_t> queryCount;
+		std::atomic<uint64_t> nodesExpanded;
+		std::atomic<uint64_t> nodesGenerated;
+		std::atomic<uint64_t> heapPushes;
+		std::atomic<uint64_t> heapPops;
+		std::atomic<uint64_t> heapDecreaseKeys;
+		std::atomic<uint64_t> peakOpenSize;
+		std::atomic<uint64_t> bytesAllocated;
+		std::atomic<uint64_t> nanoseconds;
+		std::atomic<uint64_t> slowestNanoseconds;
+	};
+}
@@ -14,8 +14,6 @@ namespace VulkanProject
 		this->x = tile->getX();
 		this->y = tile->getY();
 		this->barrier = tile->isBarrier();
-
-		this->parent = tile->getParent();
 	}
 
 	Tile::Tile(int xy[2], bool barrier)
@@ -51,16 +49,6 @@ namespace VulkanProject
 		return barrier;
 	}
 
-	Tile* Tile::getParent()
-	{
-		return parent;
-	}
-
-	void Tile::setParent(Tile* parent)
-	{
-		this->parent = parent;
-	}
-
 	void Tile::setX(int x)
 	{
 		this->x = x;
@@ -15,11 +15,9 @@ namespace VulkanProject
 		int getX() const;
 		int getY() const;
 		bool isBarrier() const;
-		Tile* getParent();
 		void setX(int x);
 		void setY(int y);
 		void setBarrier(bool barrier);
-		void setParent(Tile* parent);
 		bool equals(Tile other);
 
 	public:
@@ -38,8 +36,6 @@ namespace VulkanProject
 		int x;
 		int y;
 		bool barrier;
-
-		Tile* parent = nullptr;
 	};
 }
 
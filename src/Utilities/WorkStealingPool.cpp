@@ -0,0 +1,200 @@
+#include "WorkStealingPool.h"
+#include <stdexcept>
+
+namespace VulkanProject
+{
+	WorkStealingPool::WorkStealingPool()
+	{
+		stolenCount = 0;
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(stateMutex);
+			stopping = true;
+		}
+		batchStarted.notify_all();
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	WorkStealingPool* WorkStealingPool::getInstance()
+	{
+		static WorkStealingPool instance = WorkStealingPool();
+		return &instance;
+	}
+
+	void WorkStealingPool::run(size_t taskCount, unsigned int threadCount, const std::function<void(size_t)>& task)
+	{
+		std::lock_guard<std::mutex> runLock(runMutex);
+		stolenCount = 0;
+		if (taskCount == 0)
+		{
+			return;
+		}
+		if (taskCount > UINT32_MAX)
+		{
+			throw std::runtime_error("Too many tasks for one batch!");
+		}
+
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threadCount = (unsigned int)std::min<size_t>(threadCount, taskCount);
+
+		// The pool only grows; workers left out of a smaller batch keep sleeping
+		while (workers.size() + 1 < threadCount)
+		{
+			workers.emplace_back(&WorkStealingPool::workerLoop, this, (unsigned int)workers.size() + 1, generation);
+		}
+
+		shares = std::vector<Share>(threadCount);
+		for (unsigned int participant = 0; participant < threadCount; participant++)
+		{
+			uint32_t begin = (uint32_t)(taskCount * participant / threadCount);
+			uint32_t end = (uint32_t)(taskCount * (participant + 1) / threadCount);
+			shares[participant].range.store(packRange(begin, end), std::memory_order_relaxed);
+		}
+
+		// Publishing the batch under the lock also publishes the shares written above
+		{
+			std::lock_guard<std::mutex> lock(stateMutex);
+			currentTask = &task;
+			participantCount = threadCount;
+			busyWorkers = threadCount - 1;
+			generation++;
+		}
+		batchStarted.notify_all();
+
+		// The calling thread is participant 0
+		work(0);
+
+		std::unique_lock<std::mutex> lock(stateMutex);
+		batchFinished.wait(lock, [&]() { return busyWorkers == 0; });
+		currentTask = nullptr;
+	}
+
+	unsigned int WorkStealingPool::getWorkerCount() const
+	{
+		return (unsigned int)workers.size();
+	}
+
+	size_t WorkStealingPool::getStolenCount() const
+	{
+		return stolenCount.load(std::memory_order_relaxed);
+	}
+
+	void WorkStealingPool::workerLoop(unsigned int participant, uint64_t seenGeneration)
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(stateMutex);
+				batchStarted.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+				if (stopping)
+				{
+					return;
+				}
+				seenGeneration = generation;
+				if (participant >= participantCount)
+				{
+					continue;
+				}
+			}
+
+			work(participant);
+
+			std::lock_guard<std::mutex> lock(stateMutex);
+			if (--busyWorkers == 0)
+			{
+				batchFinished.notify_one();
+			}
+		}
+	}
+
+	void WorkStealingPool::work(unsigned int participant)
+	{
+		while (true)
+		{
+			size_t task;
+			if (takeTask(participant, task))
+			{
+				(*currentTask)(task);
+			}
+			else if (!steal(participant))
+			{
+				return;
+			}
+		}
+	}
+
+	bool WorkStealingPool::takeTask(unsigned int participant, size_t& task)
+	{
+		// Task indices are the only thing handed over, and the batch's results are published by the locks in run()
+		std::atomic<uint64_t>& range = shares[participant].range;
+		uint64_t current = range.load(std::memory_order_relaxed);
+		while (true)
+		{
+			uint32_t begin = (uint32_t)(current >> 32);
+			uint32_t end = (uint32_t)current;
+			if (begin >= end)
+			{
+				return false;
+			}
+			if (range.compare_exchange_weak(current, packRange(begin + 1, end), std::memory_order_relaxed))
+			{
+				task = begin;
+				return true;
+			}
+		}
+	}
+
+	bool WorkStealingPool::steal(unsigned int participant)
+	{
+		while (true)
+		{
+			// Robbing the largest share keeps steals rare and the stolen tasks contiguous
+			unsigned int victim = participant;
+			uint64_t victimRange = 0;
+			uint32_t largest = 0;
+			for (unsigned int other = 0; other < participantCount; other++)
+			{
+				uint64_t range = shares[other].range.load(std::memory_order_relaxed);
+				uint32_t begin = (uint32_t)(range >> 32);
+				uint32_t end = (uint32_t)range;
+				if (other != participant && end > begin && end - begin > largest)
+				{
+					victim = other;
+					victimRange = range;
+					largest = end - begin;
+				}
+			}
+			if (largest == 0)
+			{
+				return false;
+			}
+
+			uint32_t begin = (uint32_t)(victimRange >> 32);
+			uint32_t end = (uint32_t)victimRange;
+			uint32_t taken = (largest + 1) / 2;
+			if (shares[victim].range.compare_exchange_strong(victimRange, packRange(begin, end - taken), std::memory_order_relaxed))
+			{
+				// Nobody else writes an empty share, so a plain store refills this one
+				shares[participant].range.store(packRange(end - taken, end), std::memory_order_relaxed);
+				stolenCount.fetch_add(taken, std::memory_order_relaxed);
+				return true;
+			}
+			// The victim or another thief got there first: look again
+		}
+	}
+
+	uint64_t WorkStealingPool::packRange(uint32_t begin, uint32_t end)
+	{
+		return ((uint64_t)begin << 32) | end;
+	}
+}
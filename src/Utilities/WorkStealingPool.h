@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VulkanProject
+{
+	// Persistent worker threads for batches of independent tasks. Every participant starts with an equal,
+	// contiguous share of the task indices and works through it front to back; one that runs dry steals the back
+	// half of the largest share left. Contiguous shares keep neighbouring tasks on one thread, and since the
+	// threads outlive a batch, their thread_local scratch state (see Search) stays allocated between batches.
+	// One batch runs at a time and the calling thread takes part in it, so run() must not be called from a task.
+	class WorkStealingPool
+	{
+	public:
+		static WorkStealingPool* getInstance();
+		// Calls task(i) once for every i in [0, taskCount) on up to threadCount threads (0 = one per hardware
+		// thread) and returns once every call has finished
+		void run(size_t taskCount, unsigned int threadCount, const std::function<void(size_t)>& task);
+		unsigned int getWorkerCount() const;
+		// Tasks taken from another thread's share during the most recent run
+		size_t getStolenCount() const;
+
+	private:
+		WorkStealingPool();
+		~WorkStealingPool();
+		void workerLoop(unsigned int participant, uint64_t seenGeneration);
+		void work(unsigned int participant);
+		bool takeTask(unsigned int participant, size_t& task);
+		bool steal(unsigned int participant);
+
+		static uint64_t packRange(uint32_t begin, uint32_t end);
+
+		// Remaining task indices [begin, end) of one participant, begin in the high half so that the owner taking
+		// from the front and a thief taking from the back both change the range with one compare-exchange
+		struct alignas(64) Share
+		{
+			std::atomic<uint64_t> range;
+		};
+
+		std::vector<std::thread> workers;
+		std::vector<Share> shares;
+		const std::function<void(size_t)>* currentTask = nullptr;
+		unsigned int participantCount = 0;
+		// Bumped for every batch; workers that saw the current one wait for the next
+		uint64_t generation = 0;
+		unsigned int busyWorkers = 0;
+		bool stopping = false;
+		std::mutex stateMutex;
+		std::condition_variable batchStarted;
+		std::condition_variable batchFinished;
+		// Held for a whole run, so concurrent callers take turns
+		std::mutex runMutex;
+		std::atomic<size_t> stolenCount;
+	};
+}